@@ -1,4 +1,5 @@
 
+#include "AtlasPacker.h"
 #include "DataLoader.h"
 #include "Fragment3D.h"
 #include "Projector.h"
@@ -6,10 +7,13 @@
 #include "happly.h"
 #include <filesystem>
 #include <iostream>
-int main() {
+#include <string_view>
+#include <vector>
+int main(int argc, char *argv[]) {
 
   // initiate the DataLoader to read in the .ply data
   projection_generator::DataLoader data_loader;
+  data_loader.EnableCache(getDataFolder() / "cache");
   std::cout << "DataLoader initiated." << std::endl;
 
   // construct the path to the .ply file
@@ -17,39 +21,34 @@ int main() {
   sf::VertexArray test;
   std::cout << "Path to .ply file: " << ply_file.string() << std::endl;
 
-  happly::PLYData ply_data = data_loader.LoadDataFromPlyFile(ply_file.string());
-  std::cout << "Data loaded from .ply file." << std::endl;
-
-  // create a Fragment3D object from the loaded data
-  projection_generator::Fragment3D fragment{ply_data};
+  // create a Fragment3D object straight from the file
+  projection_generator::Fragment3D fragment =
+      data_loader.LoadFragment(ply_file);
   std::cout << "Fragment3D object created." << std::endl;
 
+  // "--atlas <image>" packs the sweep into a texture atlas without opening
+  // a window
+  if (argc == 3 && std::string_view(argv[1]) == "--atlas") {
+    projection_generator::AtlasPacker atlas_packer;
+    const std::vector<projection_generator::Atlas> atlases =
+        atlas_packer.PackFragmentsAboutY({&fragment, 1}, 48);
+    projection_generator::WriteAtlas(atlases.front(), argv[2]);
+    std::cout << "Atlas written to " << argv[2] << ", "
+              << 100.0 * atlases.front().m_coverage << "% covered."
+              << std::endl;
+    return 0;
+  }
+
   projection_generator::Projector projector;
   std::cout << "Projector object created." << std::endl;
 
-  // // Rotate the fragment about the Y-axis with 12
-  projector.RotateFragmentAboutY(fragment, 48);
-
-  // print out the number of vertex arrays produced and the size of each
-  const auto &projected_shapes = projector.GetProjectedShapes();
-  std::cout << "Number of projected shapes: " << projected_shapes.size()
-            << std::endl;
-  for (size_t i = 0; i < projected_shapes.size(); ++i) {
-    std::cout << "Projected shape " << i << " has "
-              << projected_shapes[i].getVertexCount() << " vertices."
-              << std::endl;
-
-    std::cout << "Projected shape size: [x: "
-              << projected_shapes[i].getBounds().size.x
-              << ", y: " << projected_shapes[i].getBounds().size.y << "]"
-              << std::endl;
+  // rotate the fragment about the Y-axis in 48 steps, projecting each
+  // snapshot only when the window shows it, so one is held at a time
+  auto sweep = projector.SweepFragmentAboutY(fragment, 48);
+  std::cout << "Number of projected shapes: " << sweep.size() << std::endl;
+  auto current_shape = sweep.begin();
+  bool first_pass = true;
 
-    // print the position of the bounds
-    std::cout << "Projected shape bounds position: [x: "
-              << projected_shapes[i].getBounds().position.x
-              << ", y: " << projected_shapes[i].getBounds().position.y << "]"
-              << std::endl;
-  }
   // create the window
   sf::RenderWindow window(sf::VideoMode({800, 600}), "My window");
 
@@ -72,17 +71,28 @@ int main() {
     // clear the window with black color
     window.clear(sf::Color::Black);
 
-    // draw once of the projected shapes and keep a counter to cycle through
-    // them per frame
-    static size_t current_shape_index = 0;
-    if (current_shape_index < projected_shapes.size()) {
-      const auto &shape = projected_shapes[current_shape_index];
-      window.draw(shape);
-      current_shape_index = (current_shape_index + 1) % projected_shapes.size();
-    } else {
-      current_shape_index = 0; // Reset if we exceed the number of shapes
-      window.draw(projected_shapes[0]); // Draw the first shape
+    // draw one of the projected shapes per frame, starting the sweep over
+    // after the last one
+    if (current_shape == sweep.end()) {
+      current_shape = sweep.begin();
+      first_pass = false;
+    }
+    const auto &shape = current_shape->m_vertices;
+    if (first_pass) {
+      // print the size of each shape the first time it is shown
+      const sf::FloatRect bounds = projection_generator::GetVertexBounds(shape);
+      std::cout << "Projected shape " << current_shape->m_index << " has "
+                << shape.size() << " vertices." << std::endl;
+      std::cout << "Projected shape size: [x: " << bounds.size.x
+                << ", y: " << bounds.size.y << "]" << std::endl;
+
+      // print the position of the bounds
+      std::cout << "Projected shape bounds position: [x: "
+                << bounds.position.x << ", y: " << bounds.position.y << "]"
+                << std::endl;
     }
+    window.draw(shape.data(), shape.size(), sf::PrimitiveType::Triangles);
+    ++current_shape;
 
     // end the current frame
     window.display();
@@ -7,10 +7,521 @@
 /// Headers
 /////////////////////////////////////////////////
 #include "DataLoader.h"
+#include "ObjReader.h"
+#include "VoxReader.h"
 #include "happly.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace projection_generator {
 
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Read one little endian scalar of the given PLY type and convert it
+/// to T
+/////////////////////////////////////////////////
+template <typename T> T ReadBinaryScalar(const std::byte *source, PlyType type) {
+  switch (type) {
+  case PlyType::Int8: {
+    std::int8_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<T>(value);
+  }
+  case PlyType::UInt8: {
+    std::uint8_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<T>(value);
+  }
+  case PlyType::Int16: {
+    std::int16_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<T>(value);
+  }
+  case PlyType::UInt16: {
+    std::uint16_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<T>(value);
+  }
+  case PlyType::Int32: {
+    std::int32_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<T>(value);
+  }
+  case PlyType::UInt32: {
+    std::uint32_t value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<T>(value);
+  }
+  case PlyType::Float32: {
+    float value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<T>(value);
+  }
+  case PlyType::Float64: {
+    double value;
+    std::memcpy(&value, source, sizeof(value));
+    return static_cast<T>(value);
+  }
+  }
+  return T{};
+}
+
+/////////////////////////////////////////////////
+/// @brief Cursor over the body of a binary PLY file that refuses to read past
+/// the end of the mapping
+/////////////////////////////////////////////////
+struct BinaryCursor {
+  const std::byte *m_position;
+  const std::byte *m_end;
+
+  const std::byte *Take(std::size_t num_bytes) {
+    if (static_cast<std::size_t>(m_end - m_position) < num_bytes) {
+      throw std::runtime_error("Binary PLY body is truncated.");
+    }
+    const std::byte *start = m_position;
+    m_position += num_bytes;
+    return start;
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Take count records of stride bytes, checking the count before
+  /// it is multiplied
+  /////////////////////////////////////////////////
+  const std::byte *TakeRecords(std::size_t count, std::size_t stride) {
+    if (!FitsInPlyBody(0, count, stride,
+                       static_cast<std::size_t>(m_end - m_position))) {
+      throw std::runtime_error("Binary PLY body is truncated.");
+    }
+    return Take(count * stride);
+  }
+};
+
+/////////////////////////////////////////////////
+/// @brief Step over one record of an element, including any list properties
+/////////////////////////////////////////////////
+void SkipBinaryRecord(BinaryCursor &cursor, const PlyElement &element) {
+  for (const auto &property : element.m_properties) {
+    if (property.m_is_list) {
+      size_t count = ReadBinaryScalar<size_t>(
+          cursor.Take(GetPlyTypeSize(property.m_list_count_type)),
+          property.m_list_count_type);
+      cursor.TakeRecords(count, GetPlyTypeSize(property.m_type));
+    } else {
+      cursor.Take(GetPlyTypeSize(property.m_type));
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Byte offset of each property inside a fixed size record, as worked
+/// out by ParsePlyHeader
+/////////////////////////////////////////////////
+std::vector<std::size_t> GetPropertyOffsets(const PlyElement &element) {
+  std::vector<std::size_t> offsets;
+  for (const auto &property : element.m_properties) {
+    offsets.push_back(property.m_record_offset.value_or(0));
+  }
+  return offsets;
+}
+
+/////////////////////////////////////////////////
+std::vector<Vertex3> ReadBinaryVertices(BinaryCursor &cursor,
+                                        const PlyElement &element) {
+
+  const std::optional<std::size_t> stride = element.GetFixedStride();
+  if (!stride) {
+    throw std::runtime_error("PLY vertex element has list properties.");
+  }
+
+  const auto x = element.FindProperty("x");
+  const auto y = element.FindProperty("y");
+  const auto z = element.FindProperty("z");
+  if (!x || !y || !z) {
+    throw std::runtime_error("PLY vertex element has no x/y/z properties.");
+  }
+  const auto red = element.FindProperty("red");
+  const auto green = element.FindProperty("green");
+  const auto blue = element.FindProperty("blue");
+  const auto alpha = element.FindProperty("alpha");
+  const bool has_color = red && green && blue;
+
+  const std::vector<std::size_t> offsets = GetPropertyOffsets(element);
+  const auto &properties = element.m_properties;
+
+  // the layout MagicaVoxel and most exporters write lets us skip the per
+  // property type switch
+  const bool float_positions = properties[*x].m_type == PlyType::Float32 &&
+                               properties[*y].m_type == PlyType::Float32 &&
+                               properties[*z].m_type == PlyType::Float32;
+  const bool byte_colors = has_color &&
+                           properties[*red].m_type == PlyType::UInt8 &&
+                           properties[*green].m_type == PlyType::UInt8 &&
+                           properties[*blue].m_type == PlyType::UInt8 &&
+                           (!alpha || properties[*alpha].m_type == PlyType::UInt8);
+
+  const std::byte *records = cursor.TakeRecords(element.m_count, *stride);
+
+  std::vector<Vertex3> vertices;
+  vertices.reserve(element.m_count);
+
+  for (size_t i = 0; i < element.m_count; ++i) {
+    const std::byte *record = records + i * *stride;
+
+    glm::vec3 position;
+    if (float_positions) {
+      std::memcpy(&position.x, record + offsets[*x], sizeof(float));
+      std::memcpy(&position.y, record + offsets[*y], sizeof(float));
+      std::memcpy(&position.z, record + offsets[*z], sizeof(float));
+    } else {
+      position.x = ReadBinaryScalar<float>(record + offsets[*x],
+                                           properties[*x].m_type);
+      position.y = ReadBinaryScalar<float>(record + offsets[*y],
+                                           properties[*y].m_type);
+      position.z = ReadBinaryScalar<float>(record + offsets[*z],
+                                           properties[*z].m_type);
+    }
+
+    sf::Color color = sf::Color::White;
+    if (byte_colors) {
+      color.r = std::to_integer<std::uint8_t>(record[offsets[*red]]);
+      color.g = std::to_integer<std::uint8_t>(record[offsets[*green]]);
+      color.b = std::to_integer<std::uint8_t>(record[offsets[*blue]]);
+      if (alpha)
+        color.a = std::to_integer<std::uint8_t>(record[offsets[*alpha]]);
+    } else if (has_color) {
+      color.r = ReadBinaryScalar<std::uint8_t>(record + offsets[*red],
+                                               properties[*red].m_type);
+      color.g = ReadBinaryScalar<std::uint8_t>(record + offsets[*green],
+                                               properties[*green].m_type);
+      color.b = ReadBinaryScalar<std::uint8_t>(record + offsets[*blue],
+                                               properties[*blue].m_type);
+      if (alpha)
+        color.a = ReadBinaryScalar<std::uint8_t>(record + offsets[*alpha],
+                                                 properties[*alpha].m_type);
+    }
+
+    vertices.emplace_back(position, color);
+  }
+  return vertices;
+}
+
+/////////////////////////////////////////////////
+PolygonList ReadBinaryFaces(BinaryCursor &cursor, const PlyElement &element) {
+
+  std::optional<std::size_t> index_property =
+      element.FindProperty("vertex_indices");
+  if (!index_property)
+    index_property = element.FindProperty("vertex_index");
+  if (!index_property || !element.m_properties[*index_property].m_is_list) {
+    throw std::runtime_error("PLY face element has no vertex index list.");
+  }
+
+  // voxel and scanner exports are almost all quads or triangles
+  PolygonList faces;
+  faces.Reserve(element.m_count, element.m_count * 4);
+  std::vector<size_t> corners;
+
+  for (size_t i = 0; i < element.m_count; ++i) {
+    for (size_t p = 0; p < element.m_properties.size(); ++p) {
+      const PlyProperty &property = element.m_properties[p];
+      if (!property.m_is_list) {
+        cursor.Take(GetPlyTypeSize(property.m_type));
+        continue;
+      }
+
+      const std::size_t entry_size = GetPlyTypeSize(property.m_type);
+      size_t count = ReadBinaryScalar<size_t>(
+          cursor.Take(GetPlyTypeSize(property.m_list_count_type)),
+          property.m_list_count_type);
+      const std::byte *entries = cursor.TakeRecords(count, entry_size);
+      if (p != *index_property)
+        continue;
+
+      corners.resize(count);
+      for (size_t k = 0; k < count; ++k) {
+        corners[k] =
+            ReadBinaryScalar<size_t>(entries + k * entry_size, property.m_type);
+      }
+      faces.Add(corners);
+    }
+  }
+  return faces;
+}
+
+
+/////////////////////////////////////////////////
+/// @brief Smallest span of ascii body text worth handing to its own task
+/////////////////////////////////////////////////
+constexpr std::size_t kMinAsciiChunkBytes = 256 * 1024;
+
+/////////////////////////////////////////////////
+/// @brief What a vertex property is used for when building a Fragment3D
+/////////////////////////////////////////////////
+enum class VertexRole { Ignore, X, Y, Z, Red, Green, Blue, Alpha };
+
+/////////////////////////////////////////////////
+std::vector<VertexRole> GetVertexRoles(const PlyElement &element) {
+  std::vector<VertexRole> roles;
+  for (const auto &property : element.m_properties) {
+    VertexRole role = VertexRole::Ignore;
+    if (!property.m_is_list) {
+      if (property.m_name == "x")
+        role = VertexRole::X;
+      else if (property.m_name == "y")
+        role = VertexRole::Y;
+      else if (property.m_name == "z")
+        role = VertexRole::Z;
+      else if (property.m_name == "red")
+        role = VertexRole::Red;
+      else if (property.m_name == "green")
+        role = VertexRole::Green;
+      else if (property.m_name == "blue")
+        role = VertexRole::Blue;
+      else if (property.m_name == "alpha")
+        role = VertexRole::Alpha;
+    }
+    roles.push_back(role);
+  }
+  return roles;
+}
+
+/////////////////////////////////////////////////
+bool IsFloatType(PlyType type) {
+  return type == PlyType::Float32 || type == PlyType::Float64;
+}
+
+/////////////////////////////////////////////////
+/// @brief Parse the next whitespace separated number of an ascii line
+/////////////////////////////////////////////////
+template <typename T>
+const char *ParseAsciiNumber(const char *position, const char *line_end,
+                             T &value) {
+  while (position < line_end &&
+         (*position == ' ' || *position == '\t' || *position == '\r')) {
+    ++position;
+  }
+  auto [next, error] = std::from_chars(position, line_end, value);
+  if (error != std::errc()) {
+    throw std::runtime_error("Malformed number in ascii PLY body.");
+  }
+  return next;
+}
+
+/////////////////////////////////////////////////
+/// @brief Parse one property value as a double, whatever its declared type
+/////////////////////////////////////////////////
+const char *ParseAsciiValue(const char *position, const char *line_end,
+                            PlyType type, double &value) {
+  if (IsFloatType(type)) {
+    return ParseAsciiNumber(position, line_end, value);
+  }
+  long long integer;
+  position = ParseAsciiNumber(position, line_end, integer);
+  value = static_cast<double>(integer);
+  return position;
+}
+
+/////////////////////////////////////////////////
+void ParseAsciiVertex(const char *position, const char *line_end,
+                      const PlyElement &element,
+                      const std::vector<VertexRole> &roles, Vertex3 &vertex) {
+  vertex.m_color = sf::Color::White;
+  for (size_t p = 0; p < element.m_properties.size(); ++p) {
+    const PlyProperty &property = element.m_properties[p];
+    if (property.m_is_list) {
+      size_t count;
+      position = ParseAsciiNumber(position, line_end, count);
+      double ignored;
+      for (size_t k = 0; k < count; ++k)
+        position = ParseAsciiValue(position, line_end, property.m_type, ignored);
+      continue;
+    }
+
+    switch (roles[p]) {
+    case VertexRole::X:
+    case VertexRole::Y:
+    case VertexRole::Z: {
+      float coordinate;
+      position = ParseAsciiNumber(position, line_end, coordinate);
+      vertex.m_position[static_cast<int>(roles[p]) -
+                        static_cast<int>(VertexRole::X)] = coordinate;
+      break;
+    }
+    case VertexRole::Red:
+    case VertexRole::Green:
+    case VertexRole::Blue:
+    case VertexRole::Alpha: {
+      double channel;
+      position = ParseAsciiValue(position, line_end, property.m_type, channel);
+      const auto value = static_cast<std::uint8_t>(channel);
+      if (roles[p] == VertexRole::Red)
+        vertex.m_color.r = value;
+      else if (roles[p] == VertexRole::Green)
+        vertex.m_color.g = value;
+      else if (roles[p] == VertexRole::Blue)
+        vertex.m_color.b = value;
+      else
+        vertex.m_color.a = value;
+      break;
+    }
+    case VertexRole::Ignore: {
+      double ignored;
+      position = ParseAsciiValue(position, line_end, property.m_type, ignored);
+      break;
+    }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void ParseAsciiFace(const char *position, const char *line_end,
+                    const PlyElement &element, size_t index_property,
+                    std::vector<size_t> &corners, PolygonList &faces) {
+  for (size_t p = 0; p < element.m_properties.size(); ++p) {
+    const PlyProperty &property = element.m_properties[p];
+    double ignored;
+    if (!property.m_is_list) {
+      position = ParseAsciiValue(position, line_end, property.m_type, ignored);
+      continue;
+    }
+    size_t count;
+    position = ParseAsciiNumber(position, line_end, count);
+    if (p != index_property) {
+      for (size_t k = 0; k < count; ++k)
+        position = ParseAsciiValue(position, line_end, property.m_type, ignored);
+      continue;
+    }
+    corners.resize(count);
+    for (size_t k = 0; k < count; ++k)
+      position = ParseAsciiNumber(position, line_end, corners[k]);
+    faces.Add(corners);
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Concatenate per chunk polygon lists in order
+/////////////////////////////////////////////////
+PolygonList JoinPolygonLists(ThreadPool &thread_pool,
+                             const std::vector<PolygonList> &parts) {
+  std::vector<size_t> polygon_starts(parts.size() + 1, 0);
+  std::vector<size_t> index_starts(parts.size() + 1, 0);
+  for (size_t c = 0; c < parts.size(); ++c) {
+    polygon_starts[c + 1] = polygon_starts[c] + parts[c].size();
+    index_starts[c + 1] = index_starts[c] + parts[c].GetIndices().size();
+  }
+
+  std::vector<size_t> offsets(polygon_starts.back() + 1);
+  std::vector<size_t> indices(index_starts.back());
+  offsets.back() = indices.size();
+  thread_pool.ParallelFor(0, parts.size(), 1, [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; ++c) {
+      const std::vector<size_t> &part_offsets = parts[c].GetOffsets();
+      for (size_t i = 0; i < parts[c].size(); ++i)
+        offsets[polygon_starts[c] + i] = index_starts[c] + part_offsets[i];
+      std::ranges::copy(parts[c].GetIndices(),
+                        indices.begin() + index_starts[c]);
+    }
+  });
+  return PolygonList(std::move(offsets), std::move(indices));
+}
+
+/////////////////////////////////////////////////
+std::string ToLower(std::string text) {
+  std::ranges::transform(text, text.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  return text;
+}
+
+/////////////////////////////////////////////////
+bool IsSupportedObjectFile(const std::filesystem::path &file_path) {
+  const std::string extension = ToLower(file_path.extension().string());
+  return extension == ".ply" || extension == ".obj" || extension == ".vox";
+}
+
+/////////////////////////////////////////////////
+/// @brief Match a file name against a glob made of literals, * and ?
+/////////////////////////////////////////////////
+bool MatchesGlob(std::string_view pattern, std::string_view name) {
+  size_t p = 0;
+  size_t n = 0;
+  size_t star = std::string_view::npos;
+  size_t star_match = 0;
+  while (n < name.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+      ++p;
+      ++n;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      star_match = n;
+    } else if (star != std::string_view::npos) {
+      p = star + 1;
+      n = ++star_match;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*')
+    ++p;
+  return p == pattern.size();
+}
+
+/////////////////////////////////////////////////
+/// @brief Rough in-memory size of the Fragment3D a PLY file will build
+/////////////////////////////////////////////////
+std::uintmax_t GetEstimatedFragmentBytes(const PlyProbe &probe) {
+  return probe.m_num_vertices * sizeof(Vertex3) +
+         probe.m_num_faces * (sizeof(std::array<size_t, 4>) +
+                              2 * sizeof(std::array<size_t, 3>));
+}
+
+/////////////////////////////////////////////////
+/// @brief Files named by a LoadBatch source, sorted so batches are submitted
+/// in a stable order
+/////////////////////////////////////////////////
+std::vector<std::filesystem::path>
+CollectBatchFiles(const std::filesystem::path &source) {
+  std::vector<std::filesystem::path> files;
+  if (std::filesystem::is_directory(source)) {
+    for (const auto &entry : std::filesystem::directory_iterator(source)) {
+      if (entry.is_regular_file() && IsSupportedObjectFile(entry.path()))
+        files.push_back(entry.path());
+    }
+  } else {
+    const std::filesystem::path folder =
+        source.has_parent_path() ? source.parent_path() : ".";
+    const std::string pattern = source.filename().string();
+    for (const auto &entry : std::filesystem::directory_iterator(folder)) {
+      if (entry.is_regular_file() &&
+          MatchesGlob(pattern, entry.path().filename().string()))
+        files.push_back(entry.path());
+    }
+  }
+  std::ranges::sort(files);
+  return files;
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+DataLoader::DataLoader(ThreadPool &thread_pool) : m_thread_pool(thread_pool) {}
+
 /////////////////////////////////////////////////
 happly::PLYData DataLoader::LoadDataFromPlyFile(const std::string &file_name) {
 
@@ -18,4 +529,434 @@ happly::PLYData DataLoader::LoadDataFromPlyFile(const std::string &file_name) {
 
   return data;
 }
+
+/////////////////////////////////////////////////
+void DataLoader::EnableCache(const std::filesystem::path &cache_folder) {
+  m_cache.emplace(cache_folder);
+}
+
+/////////////////////////////////////////////////
+void DataLoader::SetFragmentOptions(const Fragment3DOptions &options) {
+  m_fragment_options = options;
+}
+
+/////////////////////////////////////////////////
+Fragment3D DataLoader::LoadFragment(const std::filesystem::path &file_path) {
+
+  const std::string extension = ToLower(file_path.extension().string());
+
+  if (extension == ".ply")
+    return LoadFragmentFromPlyFile(file_path.string());
+  if (extension == ".obj")
+    return LoadFragmentFromObjFile(file_path.string());
+  if (extension == ".vox")
+    return LoadFragmentFromVoxFile(file_path.string());
+
+  throw std::runtime_error("Unsupported object file type: " +
+                           file_path.string());
+}
+
+/////////////////////////////////////////////////
+PlyProbe DataLoader::ProbePlyFile(const std::string &file_name,
+                                  bool compute_bounds) {
+
+  MappedFile file(file_name);
+  PlyProbe probe;
+  probe.m_header = ParsePlyHeader(file.GetText());
+  probe.m_file_size = file.GetSize();
+
+  const auto vertex_element_index = probe.m_header.FindElement("vertex");
+  if (!vertex_element_index) {
+    throw std::runtime_error("PLY file has no vertex element.");
+  }
+  const PlyElement &vertex_element =
+      probe.m_header.m_elements[*vertex_element_index];
+  probe.m_num_vertices = vertex_element.m_count;
+  if (const auto face_element_index = probe.m_header.FindElement("face")) {
+    probe.m_num_faces = probe.m_header.m_elements[*face_element_index].m_count;
+  }
+
+  const auto x = vertex_element.FindProperty("x");
+  const auto y = vertex_element.FindProperty("y");
+  const auto z = vertex_element.FindProperty("z");
+  if (!x || !y || !z) {
+    throw std::runtime_error("PLY vertex element has no x/y/z properties.");
+  }
+
+  if (probe.m_header.m_format == PlyFormat::Ascii) {
+    return probe;
+  }
+
+  // every element with a known offset and size must fit in the file
+  for (const auto &element : probe.m_header.m_elements) {
+    const auto stride = element.GetFixedStride();
+    if (element.m_file_offset && stride &&
+        !FitsInPlyBody(*element.m_file_offset, element.m_count, *stride,
+                       file.GetSize())) {
+      throw std::runtime_error("Binary PLY body is truncated.");
+    }
+  }
+
+  if (!compute_bounds || vertex_element.m_count == 0 ||
+      !vertex_element.m_file_offset ||
+      probe.m_header.m_format != PlyFormat::BinaryLittleEndian ||
+      std::endian::native != std::endian::little) {
+    return probe;
+  }
+
+  // strided walk over just the position fields of the vertex records
+  const std::size_t stride = *vertex_element.GetFixedStride();
+  const std::array<const PlyProperty *, 3> axes{
+      &vertex_element.m_properties[*x], &vertex_element.m_properties[*y],
+      &vertex_element.m_properties[*z]};
+  const std::byte *records = file.GetData() + *vertex_element.m_file_offset;
+  PlyBounds bounds;
+  for (size_t axis = 0; axis < 3; ++axis) {
+    bounds.m_min[axis] = std::numeric_limits<float>::max();
+    bounds.m_max[axis] = std::numeric_limits<float>::lowest();
+  }
+  for (size_t i = 0; i < vertex_element.m_count; ++i) {
+    const std::byte *record = records + i * stride;
+    for (size_t axis = 0; axis < 3; ++axis) {
+      const float value = ReadBinaryScalar<float>(
+          record + *axes[axis]->m_record_offset, axes[axis]->m_type);
+      bounds.m_min[axis] = std::min(bounds.m_min[axis], value);
+      bounds.m_max[axis] = std::max(bounds.m_max[axis], value);
+    }
+  }
+  probe.m_bounds = bounds;
+  return probe;
+}
+
+/////////////////////////////////////////////////
+Fragment3D DataLoader::LoadFragmentFromPlyFile(const std::string &file_name) {
+  return LoadThroughCache(file_name, [this](const std::string &path) {
+    return BuildFragmentFromPlyFile(path);
+  });
+}
+
+/////////////////////////////////////////////////
+Fragment3D DataLoader::LoadFragmentFromObjFile(const std::string &file_name) {
+  return LoadThroughCache(file_name, [this](const std::string &path) {
+    return ObjReader(m_thread_pool).Read(path, m_fragment_options);
+  });
+}
+
+/////////////////////////////////////////////////
+Fragment3D DataLoader::LoadFragmentFromVoxFile(const std::string &file_name) {
+  return LoadThroughCache(file_name, [this](const std::string &path) {
+    return VoxReader().Read(path, m_fragment_options);
+  });
+}
+
+/////////////////////////////////////////////////
+std::vector<std::filesystem::path> DataLoader::LoadBatch(
+    const std::filesystem::path &source,
+    const std::function<void(const std::filesystem::path &, Fragment3D &&)>
+        &on_loaded,
+    const BatchLoadOptions &options) {
+
+  std::vector<std::filesystem::path> failed;
+
+  // size every job up front: PLY files are probed, which also rejects broken
+  // headers before they reach a worker, other formats count their file size
+  std::vector<std::filesystem::path> files;
+  std::vector<std::uintmax_t> file_sizes;
+  {
+    std::vector<std::pair<std::uintmax_t, std::filesystem::path>> jobs;
+    for (auto &file : CollectBatchFiles(source)) {
+      try {
+        if (ToLower(file.extension().string()) == ".ply") {
+          jobs.emplace_back(
+              GetEstimatedFragmentBytes(ProbePlyFile(file.string(), false)),
+              std::move(file));
+        } else {
+          jobs.emplace_back(std::filesystem::file_size(file), std::move(file));
+        }
+      } catch (const std::exception &exception) {
+        std::cerr << "[ERROR] Rejected " << file.string() << ": "
+                  << exception.what() << std::endl;
+        failed.push_back(std::move(file));
+      }
+    }
+    // biggest first so the long jobs overlap the tail of small ones
+    std::ranges::stable_sort(jobs, std::greater{},
+                             [](const auto &job) { return job.first; });
+    for (auto &[size, file] : jobs) {
+      file_sizes.push_back(size);
+      files.push_back(std::move(file));
+    }
+  }
+
+  // finished loads are queued here by the workers and drained by the caller
+  struct Completion {
+    size_t m_file_index;
+    std::optional<Fragment3D> m_fragment;
+    std::string m_error;
+  };
+  struct CompletionQueue {
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Completion> m_completions;
+  };
+  auto queue = std::make_shared<CompletionQueue>();
+
+  size_t next_file = 0;
+  size_t num_outstanding = 0;
+  std::uintmax_t bytes_in_flight = 0;
+
+  auto wait_for_completion = [&queue]() {
+    std::unique_lock lock(queue->m_mutex);
+    queue->m_condition.wait(lock,
+                            [&queue]() { return !queue->m_completions.empty(); });
+    Completion completion = std::move(queue->m_completions.front());
+    queue->m_completions.pop_front();
+    return completion;
+  };
+
+  try {
+    while (next_file < files.size() || num_outstanding > 0) {
+      // submit while the next file fits under the cap, always allowing one
+      while (next_file < files.size() &&
+             (bytes_in_flight == 0 ||
+              bytes_in_flight + file_sizes[next_file] <=
+                  options.m_max_bytes_in_flight)) {
+        const size_t file_index = next_file++;
+        bytes_in_flight += file_sizes[file_index];
+        ++num_outstanding;
+        m_thread_pool.Submit([this, queue, file_index, &files]() {
+          Completion completion{file_index, std::nullopt, {}};
+          try {
+            completion.m_fragment = LoadFragment(files[file_index]);
+          } catch (const std::exception &exception) {
+            completion.m_error = exception.what();
+          }
+          {
+            std::lock_guard lock(queue->m_mutex);
+            queue->m_completions.push_back(std::move(completion));
+          }
+          queue->m_condition.notify_one();
+        });
+      }
+
+      Completion completion = wait_for_completion();
+      --num_outstanding;
+      if (completion.m_fragment) {
+        on_loaded(files[completion.m_file_index],
+                  std::move(*completion.m_fragment));
+      } else {
+        std::cerr << "[ERROR] Failed to load "
+                  << files[completion.m_file_index].string() << ": "
+                  << completion.m_error << std::endl;
+        failed.push_back(files[completion.m_file_index]);
+      }
+      // the memory counts as in flight until the callback has consumed it
+      bytes_in_flight -= file_sizes[completion.m_file_index];
+    }
+  } catch (...) {
+    // the workers still reference files and this loader, so let them finish
+    // before unwinding
+    for (; num_outstanding > 0; --num_outstanding)
+      wait_for_completion();
+    throw;
+  }
+  return failed;
+}
+
+/////////////////////////////////////////////////
+Fragment3D DataLoader::LoadThroughCache(
+    const std::string &file_name,
+    const std::function<Fragment3D(const std::string &)> &build) {
+
+  if (!m_cache) {
+    return build(file_name);
+  }
+
+  if (std::optional<Fragment3D> cached =
+          m_cache->Load(file_name, m_fragment_options)) {
+    std::cout << "[DEBUG] Loaded " << file_name << " from mesh cache."
+              << std::endl;
+    return std::move(*cached);
+  }
+
+  Fragment3D fragment = build(file_name);
+  try {
+    m_cache->Store(file_name, fragment, m_fragment_options);
+  } catch (const std::exception &exception) {
+    // a failed cache write only costs the next run a parse
+    std::cerr << "[ERROR] Could not write mesh cache for " << file_name << ": "
+              << exception.what() << std::endl;
+  }
+  return fragment;
+}
+
+/////////////////////////////////////////////////
+Fragment3D DataLoader::BuildFragmentFromPlyFile(const std::string &file_name) {
+
+  MappedFile file(file_name);
+  PlyHeader header = ParsePlyHeader(file.GetText());
+
+  if (header.m_format == PlyFormat::BinaryLittleEndian &&
+      std::endian::native == std::endian::little) {
+    return LoadFragmentFromBinaryPly(file, header);
+  }
+  if (header.m_format == PlyFormat::Ascii) {
+    return LoadFragmentFromAsciiPly(file, header);
+  }
+
+  // big endian files are rare enough to leave to happly
+  happly::PLYData data = LoadDataFromPlyFile(file_name);
+  return Fragment3D{data, m_fragment_options};
+}
+
+/////////////////////////////////////////////////
+Fragment3D DataLoader::LoadFragmentFromBinaryPly(const MappedFile &file,
+                                                 const PlyHeader &header) {
+
+  BinaryCursor cursor{file.GetData() + header.m_body_offset,
+                      file.GetData() + file.GetSize()};
+
+  std::vector<Vertex3> vertices;
+  PolygonList faces;
+
+  // elements are stored in header order, so anything we do not use still has
+  // to be stepped over
+  for (const auto &element : header.m_elements) {
+    if (element.m_name == "vertex") {
+      vertices = ReadBinaryVertices(cursor, element);
+    } else if (element.m_name == "face") {
+      faces = ReadBinaryFaces(cursor, element);
+    } else if (auto stride = element.GetFixedStride()) {
+      cursor.TakeRecords(element.m_count, *stride);
+    } else {
+      for (size_t i = 0; i < element.m_count; ++i)
+        SkipBinaryRecord(cursor, element);
+    }
+  }
+
+  std::cout << "[DEBUG] Loaded " << vertices.size() << " vertices and "
+            << faces.size() << " faces from binary PLY." << std::endl;
+
+  return Fragment3D{std::move(vertices), std::move(faces), m_fragment_options};
+}
+
+/////////////////////////////////////////////////
+Fragment3D DataLoader::LoadFragmentFromAsciiPly(const MappedFile &file,
+                                                const PlyHeader &header) {
+
+  const std::string_view body = file.GetText().substr(header.m_body_offset);
+
+  // every record is one line, so each element owns a fixed range of lines
+  std::vector<size_t> element_first_line;
+  size_t num_record_lines = 0;
+  for (const auto &element : header.m_elements) {
+    element_first_line.push_back(num_record_lines);
+    num_record_lines += element.m_count;
+  }
+
+  const auto vertex_element_index = header.FindElement("vertex");
+  const auto face_element_index = header.FindElement("face");
+  if (!vertex_element_index) {
+    throw std::runtime_error("PLY file has no vertex element.");
+  }
+  const PlyElement &vertex_element = header.m_elements[*vertex_element_index];
+  const std::vector<VertexRole> vertex_roles = GetVertexRoles(vertex_element);
+  if (std::ranges::count(vertex_roles, VertexRole::X) == 0 ||
+      std::ranges::count(vertex_roles, VertexRole::Y) == 0 ||
+      std::ranges::count(vertex_roles, VertexRole::Z) == 0) {
+    throw std::runtime_error("PLY vertex element has no x/y/z properties.");
+  }
+
+  size_t face_index_property = 0;
+  if (face_element_index) {
+    const PlyElement &face_element = header.m_elements[*face_element_index];
+    std::optional<std::size_t> index_property =
+        face_element.FindProperty("vertex_indices");
+    if (!index_property)
+      index_property = face_element.FindProperty("vertex_index");
+    if (!index_property ||
+        !face_element.m_properties[*index_property].m_is_list) {
+      throw std::runtime_error("PLY face element has no vertex index list.");
+    }
+    face_index_property = *index_property;
+  }
+
+  // cut the body into chunks that each start at the beginning of a line
+  const size_t num_chunks = std::clamp<size_t>(
+      body.size() / kMinAsciiChunkBytes, 1, m_thread_pool.GetThreadCount() * 8);
+  std::vector<size_t> chunk_starts(num_chunks + 1, body.size());
+  chunk_starts[0] = 0;
+  for (size_t c = 1; c < num_chunks; ++c) {
+    size_t start = std::max(body.size() * c / num_chunks, chunk_starts[c - 1]);
+    size_t newline = body.find('\n', start);
+    chunk_starts[c] =
+        newline == std::string_view::npos ? body.size() : newline + 1;
+  }
+
+  // count the lines in each chunk so every chunk knows its first line index
+  std::vector<size_t> chunk_first_line(num_chunks + 1, 0);
+  m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; ++c) {
+      chunk_first_line[c + 1] = static_cast<size_t>(
+          std::count(body.begin() + chunk_starts[c],
+                     body.begin() + chunk_starts[c + 1], '\n'));
+    }
+  });
+  for (size_t c = 0; c < num_chunks; ++c) {
+    chunk_first_line[c + 1] += chunk_first_line[c];
+  }
+  const size_t num_lines = chunk_first_line[num_chunks] +
+                           (!body.empty() && body.back() != '\n' ? 1 : 0);
+  if (num_lines < num_record_lines) {
+    throw std::runtime_error("Ascii PLY body is truncated.");
+  }
+
+  // faces vary in length, so each chunk collects its own and the lists are
+  // joined in chunk order afterwards
+  std::vector<Vertex3> vertices(vertex_element.m_count);
+  std::vector<PolygonList> chunk_faces(num_chunks);
+
+  m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+    std::vector<size_t> corners;
+    for (size_t c = first; c < last; ++c) {
+      const char *position = body.data() + chunk_starts[c];
+      const char *chunk_end = body.data() + chunk_starts[c + 1];
+      size_t line = chunk_first_line[c];
+      size_t element = 0;
+
+      while (position < chunk_end && line < num_record_lines) {
+        const char *line_end = static_cast<const char *>(
+            std::memchr(position, '\n', chunk_end - position));
+        if (line_end == nullptr)
+          line_end = chunk_end;
+
+        while (line >= element_first_line[element] +
+                           header.m_elements[element].m_count) {
+          ++element;
+        }
+        const size_t record = line - element_first_line[element];
+        if (element == *vertex_element_index) {
+          ParseAsciiVertex(position, line_end, vertex_element, vertex_roles,
+                           vertices[record]);
+        } else if (face_element_index && element == *face_element_index) {
+          ParseAsciiFace(position, line_end,
+                         header.m_elements[*face_element_index],
+                         face_index_property, corners, chunk_faces[c]);
+        }
+
+        position = line_end + 1;
+        ++line;
+      }
+    }
+  });
+
+  PolygonList faces = JoinPolygonLists(m_thread_pool, chunk_faces);
+  chunk_faces = {};
+
+  std::cout << "[DEBUG] Loaded " << vertices.size() << " vertices and "
+            << faces.size() << " faces from ascii PLY using " << num_chunks
+            << " chunks." << std::endl;
+
+  return Fragment3D{std::move(vertices), std::move(faces), m_fragment_options};
+}
 } // namespace projection_generator
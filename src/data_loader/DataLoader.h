@@ -11,16 +11,178 @@
 /////////////////////////////////////////////////
 /// Headers
 /////////////////////////////////////////////////
+#include "Fragment3D.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "PlyHeader.h"
+#include "ThreadPool.h"
 #include "happly.h"
+#include <filesystem>
+#include <functional>
+#include <optional>
 #include <string>
+#include <vector>
 namespace projection_generator {
 
+/////////////////////////////////////////////////
+/// @struct BatchLoadOptions
+/// @brief Tuning for DataLoader::LoadBatch
+/////////////////////////////////////////////////
+struct BatchLoadOptions {
+  /////////////////////////////////////////////////
+  /// @brief Upper bound on the summed size of files that are being loaded or
+  /// whose fragments have not been handed to the callback yet. A single file
+  /// larger than the cap is still loaded, on its own.
+  /////////////////////////////////////////////////
+  std::size_t m_max_bytes_in_flight{512 * 1024 * 1024};
+};
+
 class DataLoader {
 
+private:
+  /////////////////////////////////////////////////
+  /// @brief Pool used to parse large files in parallel
+  /////////////////////////////////////////////////
+  ThreadPool &m_thread_pool;
+
+  /////////////////////////////////////////////////
+  /// @brief Cache of built fragments, only set once EnableCache is called
+  /////////////////////////////////////////////////
+  std::optional<MeshCache> m_cache;
+
+  /////////////////////////////////////////////////
+  /// @brief Processing applied to every fragment this loader builds
+  /////////////////////////////////////////////////
+  Fragment3DOptions m_fragment_options;
+
+  /////////////////////////////////////////////////
+  /// @brief Parse a PLY file into a Fragment3D, bypassing the cache
+  /////////////////////////////////////////////////
+  Fragment3D BuildFragmentFromPlyFile(const std::string &file_name);
+
+  /////////////////////////////////////////////////
+  /// @brief Return the cached fragment for file_name if there is a fresh one,
+  /// otherwise build it and store it in the cache
+  ///
+  /// @param file_name Path of the object file
+  /// @param build Parses file_name into a Fragment3D
+  /////////////////////////////////////////////////
+  Fragment3D
+  LoadThroughCache(const std::string &file_name,
+                   const std::function<Fragment3D(const std::string &)> &build);
+
+  /////////////////////////////////////////////////
+  /// @brief Build a Fragment3D straight from the bytes of a mapped
+  /// binary_little_endian PLY file
+  ///
+  /// @param file Mapped PLY file
+  /// @param header Header already parsed from the start of file
+  /////////////////////////////////////////////////
+  Fragment3D LoadFragmentFromBinaryPly(const MappedFile &file,
+                                       const PlyHeader &header);
+
+  /////////////////////////////////////////////////
+  /// @brief Build a Fragment3D from a mapped ascii PLY file. The body is cut
+  /// into chunks at newline boundaries and the chunks are parsed in parallel
+  /// straight into pre-sized vertex and face buffers.
+  ///
+  /// @param file Mapped PLY file
+  /// @param header Header already parsed from the start of file
+  /////////////////////////////////////////////////
+  Fragment3D LoadFragmentFromAsciiPly(const MappedFile &file,
+                                      const PlyHeader &header);
+
 public:
-  DataLoader() = default;
+  /////////////////////////////////////////////////
+  /// @brief Constructor
+  ///
+  /// @param thread_pool Pool used for parallel parsing
+  /////////////////////////////////////////////////
+  explicit DataLoader(ThreadPool &thread_pool = ThreadPool::GetShared());
+
+  /////////////////////////////////////////////////
+  /// @brief Keep built fragments in a binary cache so unchanged files are not
+  /// parsed again on the next run
+  ///
+  /// @param cache_folder Folder for the cache files (created on demand)
+  /////////////////////////////////////////////////
+  void EnableCache(const std::filesystem::path &cache_folder);
+
+  /////////////////////////////////////////////////
+  /// @brief Set the processing applied to fragments loaded from now on.
+  /// Cache entries built with other options are rebuilt.
+  ///
+  /// @param options Options passed to every Fragment3D this loader builds
+  /////////////////////////////////////////////////
+  void SetFragmentOptions(const Fragment3DOptions &options);
+
+  /////////////////////////////////////////////////
+  /// @brief Load any supported object file (.ply, .obj, .vox) into a
+  /// Fragment3D, picking the reader from the file extension
+  ///
+  /// @param file_path Path of the object file
+  /////////////////////////////////////////////////
+  Fragment3D LoadFragment(const std::filesystem::path &file_path);
 
   // Method to load data from a PLY file
   happly::PLYData LoadDataFromPlyFile(const std::string &file_name);
+
+  /////////////////////////////////////////////////
+  /// @brief Load a PLY file directly into a Fragment3D. Binary little endian
+  /// and ascii files are memory mapped and decoded in place, big endian files
+  /// fall back to happly. If the cache is enabled a fresh cache entry is used
+  /// instead of parsing, and a new entry is written after parsing.
+  ///
+  /// @param file_name Path of the PLY file
+  /////////////////////////////////////////////////
+  Fragment3D LoadFragmentFromPlyFile(const std::string &file_name);
+
+  /////////////////////////////////////////////////
+  /// @brief Describe a PLY file from its header alone: format, element
+  /// counts, property types and binary byte offsets. For binary files the
+  /// declared sizes are checked against the file size and, if asked, the
+  /// vertex bounds are found with a strided scan over the position fields.
+  /// Throws std::runtime_error for files that could not be loaded.
+  ///
+  /// @param file_name Path of the PLY file
+  /// @param compute_bounds Whether to scan binary files for vertex bounds
+  /////////////////////////////////////////////////
+  PlyProbe ProbePlyFile(const std::string &file_name,
+                        bool compute_bounds = true);
+
+  /////////////////////////////////////////////////
+  /// @brief Load a Wavefront .obj file into a Fragment3D, see ObjReader
+  ///
+  /// @param file_name Path of the .obj file
+  /////////////////////////////////////////////////
+  Fragment3D LoadFragmentFromObjFile(const std::string &file_name);
+
+  /////////////////////////////////////////////////
+  /// @brief Mesh a MagicaVoxel .vox file into a Fragment3D, see VoxReader
+  ///
+  /// @param file_name Path of the .vox file
+  /////////////////////////////////////////////////
+  Fragment3D LoadFragmentFromVoxFile(const std::string &file_name);
+
+  /////////////////////////////////////////////////
+  /// @brief Load many object files on the thread pool and hand each fragment
+  /// to on_loaded as soon as it is ready (completion order, not file order).
+  /// on_loaded always runs on the calling thread. PLY files are probed first
+  /// so broken ones are rejected up front and the memory cap uses their
+  /// expected fragment size; jobs are started biggest first. Files that fail
+  /// to load are reported and skipped.
+  ///
+  /// @param source Either a directory, in which case every supported file in
+  /// it is loaded, or a glob on file names such as "assets/wall_*.ply"
+  /// (supports * and ?)
+  /// @param on_loaded Called with the path and fragment of each loaded file
+  /// @param options Memory cap for the batch
+  /// @return Paths of the files that failed to load
+  /////////////////////////////////////////////////
+  std::vector<std::filesystem::path> LoadBatch(
+      const std::filesystem::path &source,
+      const std::function<void(const std::filesystem::path &, Fragment3D &&)>
+          &on_loaded,
+      const BatchLoadOptions &options = {});
 };
 } // namespace projection_generator
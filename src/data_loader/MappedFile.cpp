@@ -0,0 +1,89 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the MappedFile class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+MappedFile::MappedFile(const std::filesystem::path &file_path) {
+
+  int file_descriptor = ::open(file_path.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    throw std::runtime_error("Could not open file for mapping: " +
+                             file_path.string());
+  }
+
+  struct stat file_stat {};
+  if (::fstat(file_descriptor, &file_stat) != 0) {
+    ::close(file_descriptor);
+    throw std::runtime_error("Could not stat file: " + file_path.string());
+  }
+
+  m_size = static_cast<std::size_t>(file_stat.st_size);
+  if (m_size > 0) {
+    void *mapping =
+        ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (mapping == MAP_FAILED) {
+      ::close(file_descriptor);
+      throw std::runtime_error("Could not map file: " + file_path.string());
+    }
+    // the parsers all walk the file front to back
+    ::madvise(mapping, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const std::byte *>(mapping);
+  }
+
+  // the mapping stays valid after the descriptor is closed
+  ::close(file_descriptor);
+}
+
+/////////////////////////////////////////////////
+MappedFile::~MappedFile() { Release(); }
+
+/////////////////////////////////////////////////
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)) {}
+
+/////////////////////////////////////////////////
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Release();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+  }
+  return *this;
+}
+
+/////////////////////////////////////////////////
+void MappedFile::Release() {
+  if (m_data != nullptr) {
+    ::munmap(const_cast<std::byte *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+  }
+}
+
+/////////////////////////////////////////////////
+const std::byte *MappedFile::GetData() const { return m_data; }
+
+/////////////////////////////////////////////////
+std::size_t MappedFile::GetSize() const { return m_size; }
+
+/////////////////////////////////////////////////
+std::string_view MappedFile::GetText() const {
+  return {reinterpret_cast<const char *>(m_data), m_size};
+}
+
+} // namespace projection_generator
@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the MappedFile class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class MappedFile
+/// @brief Read-only memory mapping of a whole file. The mapping is released
+/// when the object is destroyed, so any views into it must not outlive it.
+/////////////////////////////////////////////////
+class MappedFile {
+private:
+  /////////////////////////////////////////////////
+  /// @brief Start of the mapped region, nullptr for empty files
+  /////////////////////////////////////////////////
+  const std::byte *m_data{nullptr};
+
+  /////////////////////////////////////////////////
+  /// @brief Size of the mapped region in bytes
+  /////////////////////////////////////////////////
+  std::size_t m_size{0};
+
+  void Release();
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Map the given file into memory, throws std::runtime_error if the
+  /// file cannot be opened or mapped
+  ///
+  /// @param file_path Path of the file to map
+  /////////////////////////////////////////////////
+  explicit MappedFile(const std::filesystem::path &file_path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  const std::byte *GetData() const;
+
+  std::size_t GetSize() const;
+
+  /////////////////////////////////////////////////
+  /// @brief View the mapped bytes as characters, for text formats
+  /////////////////////////////////////////////////
+  std::string_view GetText() const;
+};
+} // namespace projection_generator
@@ -0,0 +1,332 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the MeshCache class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace projection_generator {
+
+namespace {
+
+constexpr std::array<char, 8> kMagic{'F', '3', 'D', 'C', 'A', 'C', 'H', 'E'};
+
+/////////////////////////////////////////////////
+/// @brief Every buffer starts on this boundary so it can be used in place
+/////////////////////////////////////////////////
+constexpr std::uint64_t kBufferAlignment = 64;
+
+/////////////////////////////////////////////////
+/// @brief Fixed header at the start of every cache file, followed by the
+/// source path and then the aligned buffers
+/////////////////////////////////////////////////
+struct CacheHeader {
+  std::array<char, 8> m_magic;
+  std::uint32_t m_version;
+  std::uint32_t m_path_length;
+  std::uint64_t m_source_size;
+  std::int64_t m_source_mtime;
+  std::uint64_t m_content_hash;
+  std::uint64_t m_build_options;
+  std::uint64_t m_index_size;
+  std::uint64_t m_num_vertices;
+  std::uint64_t m_num_faces;
+  std::uint64_t m_num_triangles;
+  std::uint64_t m_x_offset;
+  std::uint64_t m_y_offset;
+  std::uint64_t m_z_offset;
+  std::uint64_t m_colors_offset;
+  std::uint64_t m_faces_offset;
+  std::uint64_t m_triangles_offset;
+  std::uint64_t m_file_size;
+};
+
+static_assert(std::is_trivially_copyable_v<CacheHeader>);
+static_assert(std::is_trivially_copyable_v<sf::Color>);
+static_assert(sizeof(sf::Color) == 4, "cache layout assumes packed colors");
+
+/////////////////////////////////////////////////
+/// @brief Size and modification time of a source file
+/////////////////////////////////////////////////
+struct SourceStamp {
+  std::uint64_t m_size;
+  std::int64_t m_mtime;
+};
+
+/////////////////////////////////////////////////
+SourceStamp GetSourceStamp(const std::filesystem::path &source_path) {
+  return {static_cast<std::uint64_t>(std::filesystem::file_size(source_path)),
+          static_cast<std::int64_t>(std::filesystem::last_write_time(source_path)
+                                        .time_since_epoch()
+                                        .count())};
+}
+
+/////////////////////////////////////////////////
+/// @brief 64 bit FNV-1a over 8 byte words, fast enough to run at close to
+/// memory bandwidth on a mapped file
+/////////////////////////////////////////////////
+std::uint64_t HashBytes(const std::byte *data, std::size_t size) {
+  constexpr std::uint64_t kPrime = 0x100000001b3ull;
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ std::to_integer<std::uint64_t>(data[i])) * kPrime;
+  }
+  return hash;
+}
+
+/////////////////////////////////////////////////
+std::uint64_t HashFile(const std::filesystem::path &source_path) {
+  MappedFile source(source_path);
+  return HashBytes(source.GetData(), source.GetSize());
+}
+
+/////////////////////////////////////////////////
+/// @brief Pack the Fragment3DOptions into the header, one bit per switch
+/////////////////////////////////////////////////
+std::uint64_t EncodeBuildOptions(const Fragment3DOptions &options) {
+  std::uint64_t bits = 0;
+  if (options.m_weld_vertices)
+    bits |= 1u << 0;
+  if (options.m_greedy_mesh)
+    bits |= 1u << 1;
+  if (options.m_remove_interior_faces)
+    bits |= 1u << 2;
+  return bits;
+}
+
+/////////////////////////////////////////////////
+std::uint64_t AlignUp(std::uint64_t offset) {
+  return (offset + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+}
+
+/////////////////////////////////////////////////
+std::string GetKeyPath(const std::filesystem::path &source_path) {
+  return std::filesystem::absolute(source_path).lexically_normal().string();
+}
+
+/////////////////////////////////////////////////
+/// @brief Copy count elements out of the mapped cache file into a new Buffer
+/////////////////////////////////////////////////
+template <typename Buffer>
+Buffer ReadBuffer(const MappedFile &cache, std::uint64_t offset,
+                  std::uint64_t count) {
+  using T = typename Buffer::value_type;
+  if (offset > cache.GetSize() ||
+      count > (cache.GetSize() - offset) / sizeof(T)) {
+    throw std::runtime_error("Mesh cache buffer runs past end of file.");
+  }
+  Buffer buffer(count);
+  if (count > 0)
+    std::memcpy(buffer.data(), cache.GetData() + offset, count * sizeof(T));
+  return buffer;
+}
+
+/////////////////////////////////////////////////
+/// @brief Read an IndexBuffer stored with index_size bytes per index
+/////////////////////////////////////////////////
+template <std::size_t N>
+IndexBuffer<N> ReadIndexBuffer(const MappedFile &cache, std::uint64_t offset,
+                               std::uint64_t count, std::uint64_t index_size) {
+  using Buffer = IndexBuffer<N>;
+  if (index_size == sizeof(std::uint16_t)) {
+    return Buffer(ReadBuffer<typename Buffer::template Storage<std::uint16_t>>(
+        cache, offset, count));
+  }
+  if (index_size == sizeof(std::uint32_t)) {
+    return Buffer(ReadBuffer<typename Buffer::template Storage<std::uint32_t>>(
+        cache, offset, count));
+  }
+  throw std::runtime_error("Mesh cache has an unknown index size.");
+}
+
+/////////////////////////////////////////////////
+void WriteEntry(const std::filesystem::path &cache_path,
+                const std::string &key_path, const SourceStamp &stamp,
+                std::uint64_t content_hash, std::uint64_t build_options,
+                const Fragment3D &fragment) {
+
+  const auto &vertices = fragment.GetVertices();
+  const auto &faces = fragment.GetFaces();
+  const auto &triangles = fragment.GetTriangles();
+
+  CacheHeader header{};
+  header.m_magic = kMagic;
+  header.m_version = MeshCache::kVersion;
+  header.m_path_length = static_cast<std::uint32_t>(key_path.size());
+  header.m_source_size = stamp.m_size;
+  header.m_source_mtime = stamp.m_mtime;
+  header.m_content_hash = content_hash;
+  header.m_build_options = build_options;
+  header.m_index_size = faces.GetIndexSize();
+  header.m_num_vertices = vertices.size();
+  header.m_num_faces = faces.size();
+  header.m_num_triangles = triangles.size();
+  const std::uint64_t component_bytes = vertices.size() * sizeof(float);
+  header.m_x_offset = AlignUp(sizeof(CacheHeader) + key_path.size());
+  header.m_y_offset = AlignUp(header.m_x_offset + component_bytes);
+  header.m_z_offset = AlignUp(header.m_y_offset + component_bytes);
+  header.m_colors_offset = AlignUp(header.m_z_offset + component_bytes);
+  header.m_faces_offset = AlignUp(header.m_colors_offset +
+                                  vertices.size() * sizeof(sf::Color));
+  header.m_triangles_offset =
+      AlignUp(header.m_faces_offset + faces.GetBytes().size());
+  header.m_file_size = header.m_triangles_offset + triangles.GetBytes().size();
+
+  // unique per writer so concurrent loaders never share a temporary file
+  std::ostringstream temporary_name;
+  temporary_name << cache_path.filename().string() << ".tmp."
+                 << std::this_thread::get_id();
+  const std::filesystem::path temporary_path =
+      cache_path.parent_path() / temporary_name.str();
+
+  {
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Could not open mesh cache file for writing: " +
+                               temporary_path.string());
+    }
+    auto pad_to = [&out](std::uint64_t offset) {
+      static constexpr std::array<char, kBufferAlignment> kZeros{};
+      const auto position = static_cast<std::uint64_t>(out.tellp());
+      out.write(kZeros.data(), static_cast<std::streamsize>(offset - position));
+    };
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(key_path.data(), static_cast<std::streamsize>(key_path.size()));
+    auto write_span = [&out](auto span) {
+      out.write(reinterpret_cast<const char *>(span.data()),
+                static_cast<std::streamsize>(span.size_bytes()));
+    };
+    pad_to(header.m_x_offset);
+    write_span(vertices.GetX());
+    pad_to(header.m_y_offset);
+    write_span(vertices.GetY());
+    pad_to(header.m_z_offset);
+    write_span(vertices.GetZ());
+    pad_to(header.m_colors_offset);
+    write_span(vertices.GetColors());
+    pad_to(header.m_faces_offset);
+    write_span(faces.GetBytes());
+    pad_to(header.m_triangles_offset);
+    write_span(triangles.GetBytes());
+    if (!out) {
+      throw std::runtime_error("Failed writing mesh cache file: " +
+                               temporary_path.string());
+    }
+  }
+  std::filesystem::rename(temporary_path, cache_path);
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+MeshCache::MeshCache(std::filesystem::path cache_folder)
+    : m_cache_folder(std::move(cache_folder)) {}
+
+/////////////////////////////////////////////////
+std::filesystem::path
+MeshCache::GetCacheFilePath(const std::filesystem::path &source_path) const {
+  const std::string key_path = GetKeyPath(source_path);
+  std::ostringstream name;
+  name << source_path.stem().string() << '.' << std::hex
+       << HashBytes(reinterpret_cast<const std::byte *>(key_path.data()),
+                    key_path.size())
+       << ".f3dcache";
+  return m_cache_folder / name.str();
+}
+
+/////////////////////////////////////////////////
+std::optional<Fragment3D>
+MeshCache::Load(const std::filesystem::path &source_path,
+                const Fragment3DOptions &options) const {
+
+  const std::filesystem::path cache_path = GetCacheFilePath(source_path);
+  std::error_code error;
+  if (!std::filesystem::exists(cache_path, error))
+    return std::nullopt;
+
+  try {
+    MappedFile cache(cache_path);
+    CacheHeader header;
+    if (cache.GetSize() < sizeof(header))
+      return std::nullopt;
+    std::memcpy(&header, cache.GetData(), sizeof(header));
+
+    const std::string key_path = GetKeyPath(source_path);
+    if (header.m_magic != kMagic || header.m_version != kVersion ||
+        header.m_file_size != cache.GetSize() ||
+        header.m_build_options != EncodeBuildOptions(options) ||
+        header.m_path_length != key_path.size() ||
+        cache.GetSize() < sizeof(header) + key_path.size() ||
+        std::memcmp(cache.GetData() + sizeof(header), key_path.data(),
+                    key_path.size()) != 0) {
+      return std::nullopt;
+    }
+
+    const SourceStamp stamp = GetSourceStamp(source_path);
+    if (stamp.m_size != header.m_source_size)
+      return std::nullopt;
+    const bool needs_refresh = stamp.m_mtime != header.m_source_mtime;
+    if (needs_refresh && HashFile(source_path) != header.m_content_hash)
+      return std::nullopt;
+
+    const std::uint64_t num_vertices = header.m_num_vertices;
+    Fragment3D fragment{
+        VertexSoA{
+            ReadBuffer<AlignedVector<float>>(cache, header.m_x_offset,
+                                             num_vertices),
+            ReadBuffer<AlignedVector<float>>(cache, header.m_y_offset,
+                                             num_vertices),
+            ReadBuffer<AlignedVector<float>>(cache, header.m_z_offset,
+                                             num_vertices),
+            ReadBuffer<AlignedVector<sf::Color>>(cache, header.m_colors_offset,
+                                                 num_vertices)},
+        ReadIndexBuffer<4>(cache, header.m_faces_offset, header.m_num_faces,
+                           header.m_index_size),
+        ReadIndexBuffer<3>(cache, header.m_triangles_offset,
+                           header.m_num_triangles, header.m_index_size)};
+
+    // same contents under a new timestamp, record it so the next run skips
+    // the hash
+    if (needs_refresh) {
+      WriteEntry(cache_path, key_path, stamp, header.m_content_hash,
+                 header.m_build_options, fragment);
+    }
+    return fragment;
+  } catch (const std::exception &exception) {
+    std::cerr << "[ERROR] Ignoring unreadable mesh cache file "
+              << cache_path.string() << ": " << exception.what() << std::endl;
+    return std::nullopt;
+  }
+}
+
+/////////////////////////////////////////////////
+void MeshCache::Store(const std::filesystem::path &source_path,
+                      const Fragment3D &fragment,
+                      const Fragment3DOptions &options) const {
+  std::filesystem::create_directories(m_cache_folder);
+  WriteEntry(GetCacheFilePath(source_path), GetKeyPath(source_path),
+             GetSourceStamp(source_path), HashFile(source_path),
+             EncodeBuildOptions(options), fragment);
+}
+
+} // namespace projection_generator
@@ -0,0 +1,83 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the MeshCache class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "Fragment3D.h"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class MeshCache
+/// @brief On-disk cache of fully built Fragment3D buffers.
+///
+/// Each source file gets one cache file holding a fixed header followed by the
+/// vertex component, face and triangle buffers in their in-memory layout, each
+/// 64 byte aligned, so a reload is a mapping plus one copy per buffer. The
+/// copy stays because Fragment3D owns its buffers as vectors, which cannot
+/// adopt mapped memory, and it lets the mapping close once the fragment is
+/// built.
+///
+/// An entry is keyed by the source path, size, modification time and a hash
+/// of the source contents, plus the Fragment3DOptions the fragment was built
+/// with. When only the modification time differs (fresh checkout, touched
+/// file) the contents are re-hashed and the entry is reused if they match.
+/////////////////////////////////////////////////
+class MeshCache {
+private:
+  /////////////////////////////////////////////////
+  /// @brief Folder the cache files are written to
+  /////////////////////////////////////////////////
+  std::filesystem::path m_cache_folder;
+
+  std::filesystem::path GetCacheFilePath(
+      const std::filesystem::path &source_path) const;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Bump whenever the file layout or the Fragment3D build changes
+  /////////////////////////////////////////////////
+  static constexpr std::uint32_t kVersion = 4;
+
+  /////////////////////////////////////////////////
+  /// @brief Constructor, the folder is created on the first Store
+  ///
+  /// @param cache_folder Folder to keep cache files in
+  /////////////////////////////////////////////////
+  explicit MeshCache(std::filesystem::path cache_folder);
+
+  /////////////////////////////////////////////////
+  /// @brief Read the cached fragment for a source file, or std::nullopt if
+  /// there is no entry or the entry is stale or unreadable
+  ///
+  /// @param source_path Path of the original object file
+  /// @param options Options the fragment has to have been built with
+  /////////////////////////////////////////////////
+  std::optional<Fragment3D> Load(const std::filesystem::path &source_path,
+                                 const Fragment3DOptions &options) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Write the cache entry for a source file, replacing any old one.
+  /// The file is written under a temporary name and renamed into place, so
+  /// concurrent readers never see a partial entry.
+  ///
+  /// @param source_path Path of the original object file
+  /// @param fragment Fragment built from source_path
+  /// @param options Options fragment was built with
+  /////////////////////////////////////////////////
+  void Store(const std::filesystem::path &source_path,
+             const Fragment3D &fragment,
+             const Fragment3DOptions &options) const;
+};
+} // namespace projection_generator
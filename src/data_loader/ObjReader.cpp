@@ -0,0 +1,431 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the ObjReader class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ObjReader.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Smallest span of .obj text worth handing to its own task
+/////////////////////////////////////////////////
+constexpr std::size_t kMinObjChunkBytes = 256 * 1024;
+
+/////////////////////////////////////////////////
+/// @brief Everything parsed out of one chunk of an .obj file. Indices are
+/// kept raw here because relative (negative) indices and inherited materials
+/// can only be resolved once the chunks before are known.
+/////////////////////////////////////////////////
+struct ObjChunk {
+  std::vector<glm::vec3> m_positions;
+
+  /////////////////////////////////////////////////
+  /// @brief Parallel to m_positions, white unless the "v" line had a color
+  /////////////////////////////////////////////////
+  std::vector<sf::Color> m_colors;
+
+  bool m_has_vertex_colors{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Raw position index of every face corner, in face order
+  /////////////////////////////////////////////////
+  std::vector<std::int64_t> m_corners;
+
+  std::vector<std::uint32_t> m_face_sizes;
+
+  /////////////////////////////////////////////////
+  /// @brief Number of positions this chunk had read before each face, used
+  /// to resolve negative indices
+  /////////////////////////////////////////////////
+  std::vector<std::uint32_t> m_face_position_base;
+
+  /////////////////////////////////////////////////
+  /// @brief Index into m_material_names for each face, -1 if the face uses
+  /// the material active at the end of the previous chunk
+  /////////////////////////////////////////////////
+  std::vector<std::int32_t> m_face_materials;
+
+  std::vector<std::string> m_material_names;
+
+  std::vector<std::string> m_material_libraries;
+
+  /////////////////////////////////////////////////
+  /// @brief Material active at the end of the chunk, -1 if never switched
+  /////////////////////////////////////////////////
+  std::int32_t m_current_material{-1};
+};
+
+/////////////////////////////////////////////////
+bool IsSpace(char character) {
+  return character == ' ' || character == '\t' || character == '\r';
+}
+
+/////////////////////////////////////////////////
+const char *SkipSpaces(const char *position, const char *line_end) {
+  while (position < line_end && IsSpace(*position))
+    ++position;
+  return position;
+}
+
+/////////////////////////////////////////////////
+std::string_view Trim(const char *position, const char *line_end) {
+  position = SkipSpaces(position, line_end);
+  while (line_end > position && IsSpace(line_end[-1]))
+    --line_end;
+  return {position, static_cast<size_t>(line_end - position)};
+}
+
+/////////////////////////////////////////////////
+/// @brief Parse a float if there is one, leaving position alone otherwise
+/////////////////////////////////////////////////
+bool TryParseFloat(const char *&position, const char *line_end, float &value) {
+  const char *start = SkipSpaces(position, line_end);
+  auto [next, error] = std::from_chars(start, line_end, value);
+  if (error != std::errc())
+    return false;
+  position = next;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void ParseObjLine(const char *position, const char *line_end,
+                  ObjChunk &chunk) {
+  position = SkipSpaces(position, line_end);
+  if (position == line_end || *position == '#')
+    return;
+
+  const char *keyword_end = position;
+  while (keyword_end < line_end && !IsSpace(*keyword_end))
+    ++keyword_end;
+  const std::string_view keyword(position,
+                                 static_cast<size_t>(keyword_end - position));
+  position = keyword_end;
+
+  if (keyword == "v") {
+    glm::vec3 coordinates;
+    if (!TryParseFloat(position, line_end, coordinates.x) ||
+        !TryParseFloat(position, line_end, coordinates.y) ||
+        !TryParseFloat(position, line_end, coordinates.z)) {
+      throw std::runtime_error("Malformed vertex line in .obj file.");
+    }
+    chunk.m_positions.push_back(coordinates);
+
+    // optional "r g b" extension, either 0-1 floats or 0-255 values
+    glm::vec3 rgb;
+    sf::Color color = sf::Color::White;
+    if (TryParseFloat(position, line_end, rgb.x) &&
+        TryParseFloat(position, line_end, rgb.y) &&
+        TryParseFloat(position, line_end, rgb.z)) {
+      const float scale =
+          std::max({rgb.x, rgb.y, rgb.z}) > 1.0f ? 1.0f : 255.0f;
+      auto to_channel = [scale](float value) {
+        return static_cast<std::uint8_t>(
+            std::clamp(value * scale + 0.5f, 0.0f, 255.0f));
+      };
+      color = sf::Color(to_channel(rgb.x), to_channel(rgb.y),
+                        to_channel(rgb.z));
+      chunk.m_has_vertex_colors = true;
+    }
+    chunk.m_colors.push_back(color);
+  } else if (keyword == "f") {
+    std::uint32_t num_corners = 0;
+    for (;;) {
+      position = SkipSpaces(position, line_end);
+      if (position == line_end)
+        break;
+      std::int64_t index;
+      auto [next, error] = std::from_chars(position, line_end, index);
+      if (error != std::errc() || index == 0) {
+        throw std::runtime_error("Malformed face line in .obj file.");
+      }
+      chunk.m_corners.push_back(index);
+      ++num_corners;
+      // texture and normal references ("/vt/vn") carry nothing Fragment3D
+      // stores
+      position = next;
+      while (position < line_end && !IsSpace(*position))
+        ++position;
+    }
+    if (num_corners < 3) {
+      throw std::runtime_error("Face in .obj file has fewer than 3 vertices.");
+    }
+    chunk.m_face_sizes.push_back(num_corners);
+    chunk.m_face_position_base.push_back(
+        static_cast<std::uint32_t>(chunk.m_positions.size()));
+    chunk.m_face_materials.push_back(chunk.m_current_material);
+  } else if (keyword == "usemtl") {
+    const std::string name(Trim(position, line_end));
+    auto found = std::ranges::find(chunk.m_material_names, name);
+    if (found == chunk.m_material_names.end()) {
+      chunk.m_material_names.push_back(name);
+      found = chunk.m_material_names.end() - 1;
+    }
+    chunk.m_current_material = static_cast<std::int32_t>(
+        found - chunk.m_material_names.begin());
+  } else if (keyword == "mtllib") {
+    for (;;) {
+      position = SkipSpaces(position, line_end);
+      if (position == line_end)
+        break;
+      const char *name_end = position;
+      while (name_end < line_end && !IsSpace(*name_end))
+        ++name_end;
+      chunk.m_material_libraries.emplace_back(position, name_end);
+      position = name_end;
+    }
+  }
+  // vt, vn, o, g, s, l and unknown statements are skipped
+}
+
+/////////////////////////////////////////////////
+/// @brief Read the diffuse colors of every material in an .mtl file
+/////////////////////////////////////////////////
+void ReadMaterialLibrary(const std::filesystem::path &library_path,
+                         std::unordered_map<std::string, sf::Color> &colors) {
+  MappedFile library(library_path);
+  const std::string_view text = library.GetText();
+
+  std::string current_material;
+  size_t position = 0;
+  while (position < text.size()) {
+    size_t line_end = text.find('\n', position);
+    if (line_end == std::string_view::npos)
+      line_end = text.size();
+    const char *line = text.data() + position;
+    const char *end = text.data() + line_end;
+    position = line_end + 1;
+
+    line = SkipSpaces(line, end);
+    if (end - line > 7 && std::string_view(line, 7) == "newmtl ") {
+      current_material = std::string(Trim(line + 7, end));
+    } else if (end - line > 3 && std::string_view(line, 3) == "Kd ") {
+      const char *values = line + 3;
+      glm::vec3 diffuse;
+      if (TryParseFloat(values, end, diffuse.x) &&
+          TryParseFloat(values, end, diffuse.y) &&
+          TryParseFloat(values, end, diffuse.z)) {
+        auto to_channel = [](float value) {
+          return static_cast<std::uint8_t>(
+              std::clamp(value * 255.0f + 0.5f, 0.0f, 255.0f));
+        };
+        colors[current_material] =
+            sf::Color(to_channel(diffuse.x), to_channel(diffuse.y),
+                      to_channel(diffuse.z));
+      }
+    }
+  }
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+ObjReader::ObjReader(ThreadPool &thread_pool) : m_thread_pool(thread_pool) {}
+
+/////////////////////////////////////////////////
+Fragment3D ObjReader::Read(const std::filesystem::path &file_path,
+                           const Fragment3DOptions &options) {
+
+  MappedFile file(file_path);
+  const std::string_view text = file.GetText();
+
+  // cut the text into chunks that each start at the beginning of a line
+  const size_t num_chunks = std::clamp<size_t>(
+      text.size() / kMinObjChunkBytes, 1, m_thread_pool.GetThreadCount() * 8);
+  std::vector<size_t> chunk_starts(num_chunks + 1, text.size());
+  chunk_starts[0] = 0;
+  for (size_t c = 1; c < num_chunks; ++c) {
+    size_t start = std::max(text.size() * c / num_chunks, chunk_starts[c - 1]);
+    size_t newline = text.find('\n', start);
+    chunk_starts[c] =
+        newline == std::string_view::npos ? text.size() : newline + 1;
+  }
+
+  std::vector<ObjChunk> chunks(num_chunks);
+  m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; ++c) {
+      const char *position = text.data() + chunk_starts[c];
+      const char *chunk_end = text.data() + chunk_starts[c + 1];
+      while (position < chunk_end) {
+        const char *line_end = static_cast<const char *>(
+            std::memchr(position, '\n', chunk_end - position));
+        if (line_end == nullptr)
+          line_end = chunk_end;
+        ParseObjLine(position, line_end, chunks[c]);
+        position = line_end + 1;
+      }
+    }
+  });
+
+  // stitch the chunks: global offsets, materials active at each chunk start
+  std::vector<size_t> position_offsets(num_chunks + 1, 0);
+  std::vector<size_t> polygon_offsets(num_chunks + 1, 0);
+  std::vector<size_t> corner_offsets(num_chunks + 1, 0);
+  std::vector<std::string> material_names;
+  std::vector<std::vector<std::int32_t>> chunk_material_ids(num_chunks);
+  std::vector<std::int32_t> inherited_material(num_chunks, -1);
+  std::vector<std::string> material_libraries;
+  bool has_vertex_colors = false;
+  bool has_materials = false;
+
+  std::int32_t active_material = -1;
+  for (size_t c = 0; c < num_chunks; ++c) {
+    ObjChunk &chunk = chunks[c];
+    position_offsets[c + 1] = position_offsets[c] + chunk.m_positions.size();
+    polygon_offsets[c + 1] = polygon_offsets[c] + chunk.m_face_sizes.size();
+    corner_offsets[c + 1] = corner_offsets[c] + chunk.m_corners.size();
+
+    for (const auto &name : chunk.m_material_names) {
+      auto found = std::ranges::find(material_names, name);
+      if (found == material_names.end()) {
+        material_names.push_back(name);
+        found = material_names.end() - 1;
+      }
+      chunk_material_ids[c].push_back(
+          static_cast<std::int32_t>(found - material_names.begin()));
+    }
+    inherited_material[c] = active_material;
+    if (chunk.m_current_material >= 0)
+      active_material = chunk_material_ids[c][chunk.m_current_material];
+
+    has_vertex_colors = has_vertex_colors || chunk.m_has_vertex_colors;
+    has_materials = has_materials || !chunk.m_material_names.empty();
+    material_libraries.insert(material_libraries.end(),
+                              chunk.m_material_libraries.begin(),
+                              chunk.m_material_libraries.end());
+  }
+  const size_t num_positions = position_offsets[num_chunks];
+
+  // resolve every corner to a global position index and every face to a
+  // global material id
+  m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; ++c) {
+      ObjChunk &chunk = chunks[c];
+      size_t corner = 0;
+      for (size_t f = 0; f < chunk.m_face_sizes.size(); ++f) {
+        const size_t base = position_offsets[c] + chunk.m_face_position_base[f];
+        for (std::uint32_t k = 0; k < chunk.m_face_sizes[f]; ++k, ++corner) {
+          std::int64_t &index = chunk.m_corners[corner];
+          index = index > 0 ? index - 1 : static_cast<std::int64_t>(base) + index;
+          if (index < 0 || static_cast<size_t>(index) >= num_positions) {
+            throw std::runtime_error(".obj face references a missing vertex.");
+          }
+        }
+        std::int32_t &material = chunk.m_face_materials[f];
+        material = material >= 0 ? chunk_material_ids[c][material]
+                                  : inherited_material[c];
+      }
+    }
+  });
+
+  // polygons are kept whole and triangulated by Fragment3D; every chunk
+  // writes its share of the offsets and indices at its prefix sum position
+  std::vector<Vertex3> vertices;
+  std::vector<size_t> offsets(polygon_offsets[num_chunks] + 1);
+  std::vector<size_t> indices(corner_offsets[num_chunks]);
+  offsets.back() = indices.size();
+
+  if (has_vertex_colors || !has_materials) {
+    // colors live on the positions, so positions map one to one to vertices
+    vertices.resize(num_positions);
+    m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+      for (size_t c = first; c < last; ++c) {
+        const ObjChunk &chunk = chunks[c];
+        for (size_t i = 0; i < chunk.m_positions.size(); ++i) {
+          vertices[position_offsets[c] + i] =
+              Vertex3(chunk.m_positions[i], chunk.m_colors[i]);
+        }
+        size_t corner = corner_offsets[c];
+        for (size_t f = 0; f < chunk.m_face_sizes.size(); ++f) {
+          offsets[polygon_offsets[c] + f] = corner;
+          corner += chunk.m_face_sizes[f];
+        }
+        std::ranges::transform(chunk.m_corners,
+                               indices.begin() + corner_offsets[c],
+                               [](std::int64_t index) {
+                                 return static_cast<size_t>(index);
+                               });
+      }
+    });
+  } else {
+    // material colors are per face, so a position used with two materials
+    // becomes two vertices
+    std::unordered_map<std::string, sf::Color> library_colors;
+    for (const auto &library : material_libraries) {
+      try {
+        ReadMaterialLibrary(file_path.parent_path() / library, library_colors);
+      } catch (const std::exception &exception) {
+        std::cerr << "[ERROR] Could not read material library " << library
+                  << ": " << exception.what() << std::endl;
+      }
+    }
+    std::vector<sf::Color> material_colors;
+    for (const auto &name : material_names) {
+      auto found = library_colors.find(name);
+      material_colors.push_back(found != library_colors.end() ? found->second
+                                                              : sf::Color::White);
+    }
+
+    std::vector<glm::vec3> positions(num_positions);
+    for (size_t c = 0; c < num_chunks; ++c) {
+      std::ranges::copy(chunks[c].m_positions,
+                        positions.begin() + position_offsets[c]);
+      chunks[c].m_positions = {};
+    }
+
+    const std::uint64_t num_keys_per_position = material_names.size() + 1;
+    std::unordered_map<std::uint64_t, size_t> vertex_ids;
+    vertex_ids.reserve(num_positions);
+    auto vertex_for = [&](size_t position, std::int32_t material) {
+      const std::uint64_t key =
+          position * num_keys_per_position + static_cast<std::uint64_t>(material + 1);
+      auto [found, inserted] = vertex_ids.try_emplace(key, vertices.size());
+      if (inserted) {
+        vertices.emplace_back(positions[position],
+                              material >= 0 ? material_colors[material]
+                                            : sf::Color::White);
+      }
+      return found->second;
+    };
+
+    size_t polygon = 0;
+    size_t corner = 0;
+    for (const ObjChunk &chunk : chunks) {
+      size_t chunk_corner = 0;
+      for (size_t f = 0; f < chunk.m_face_sizes.size(); ++f) {
+        const std::int32_t material = chunk.m_face_materials[f];
+        offsets[polygon++] = corner;
+        for (std::uint32_t k = 0; k < chunk.m_face_sizes[f]; ++k) {
+          indices[corner++] = vertex_for(
+              static_cast<size_t>(chunk.m_corners[chunk_corner++]), material);
+        }
+      }
+    }
+  }
+
+  PolygonList polygons(std::move(offsets), std::move(indices));
+
+  std::cout << "[DEBUG] Loaded " << vertices.size() << " vertices and "
+            << polygons.size() << " faces from .obj using " << num_chunks
+            << " chunks." << std::endl;
+
+  return Fragment3D{std::move(vertices), std::move(polygons), options};
+}
+
+} // namespace projection_generator
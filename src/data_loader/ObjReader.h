@@ -0,0 +1,54 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the ObjReader class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "Fragment3D.h"
+#include "ThreadPool.h"
+#include <filesystem>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class ObjReader
+/// @brief Streaming reader for Wavefront .obj files.
+///
+/// The file is memory mapped and cut into chunks at newline boundaries. Each
+/// chunk is parsed once on the thread pool into compact per chunk buffers
+/// (positions, face corners, material switches), which are then stitched
+/// together, so memory scales with the mesh rather than with the text.
+/// Vertex colors come from the "v x y z r g b" extension when present,
+/// otherwise from the diffuse (Kd) color of the face's material. Polygons are
+/// passed on whole and triangulated by Fragment3D, so they may be concave.
+/////////////////////////////////////////////////
+class ObjReader {
+private:
+  ThreadPool &m_thread_pool;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Constructor
+  ///
+  /// @param thread_pool Pool used to parse chunks in parallel
+  /////////////////////////////////////////////////
+  explicit ObjReader(ThreadPool &thread_pool);
+
+  /////////////////////////////////////////////////
+  /// @brief Read an .obj file (and any .mtl it references) into a Fragment3D,
+  /// throws std::runtime_error on malformed input
+  ///
+  /// @param file_path Path of the .obj file
+  /// @param options Processing applied when the Fragment3D is built
+  /////////////////////////////////////////////////
+  Fragment3D Read(const std::filesystem::path &file_path,
+                  const Fragment3DOptions &options = {});
+};
+} // namespace projection_generator
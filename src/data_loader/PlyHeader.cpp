@@ -0,0 +1,227 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the PLY header parser
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "PlyHeader.h"
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+PlyType ParsePlyType(std::string_view name) {
+  if (name == "char" || name == "int8")
+    return PlyType::Int8;
+  if (name == "uchar" || name == "uint8")
+    return PlyType::UInt8;
+  if (name == "short" || name == "int16")
+    return PlyType::Int16;
+  if (name == "ushort" || name == "uint16")
+    return PlyType::UInt16;
+  if (name == "int" || name == "int32")
+    return PlyType::Int32;
+  if (name == "uint" || name == "uint32")
+    return PlyType::UInt32;
+  if (name == "float" || name == "float32")
+    return PlyType::Float32;
+  if (name == "double" || name == "float64")
+    return PlyType::Float64;
+  throw std::runtime_error("Unknown PLY property type: " + std::string(name));
+}
+
+/////////////////////////////////////////////////
+/// @brief Split a header line into whitespace separated tokens
+/////////////////////////////////////////////////
+std::vector<std::string_view> Tokenise(std::string_view line) {
+  std::vector<std::string_view> tokens;
+  size_t position = 0;
+  while (position < line.size()) {
+    size_t start = line.find_first_not_of(" \t\r", position);
+    if (start == std::string_view::npos)
+      break;
+    size_t end = line.find_first_of(" \t\r", start);
+    if (end == std::string_view::npos)
+      end = line.size();
+    tokens.push_back(line.substr(start, end - start));
+    position = end;
+  }
+  return tokens;
+}
+
+/////////////////////////////////////////////////
+/// @brief Fill in record and file offsets as far as they are fixed
+/////////////////////////////////////////////////
+void ComputeBinaryOffsets(PlyHeader &header) {
+  std::optional<std::size_t> file_offset = header.m_body_offset;
+  for (auto &element : header.m_elements) {
+    element.m_file_offset = file_offset;
+
+    std::optional<std::size_t> record_offset = 0;
+    for (auto &property : element.m_properties) {
+      if (property.m_is_list)
+        record_offset.reset();
+      property.m_record_offset = record_offset;
+      if (record_offset)
+        *record_offset += GetPlyTypeSize(property.m_type);
+    }
+
+    const std::optional<std::size_t> stride = element.GetFixedStride();
+    // an element too large to address leaves every later offset unknown
+    if (file_offset && stride &&
+        FitsInPlyBody(*file_offset, element.m_count, *stride,
+                      std::numeric_limits<std::size_t>::max()))
+      *file_offset += element.m_count * *stride;
+    else
+      file_offset.reset();
+  }
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+std::size_t GetPlyTypeSize(PlyType type) {
+  switch (type) {
+  case PlyType::Int8:
+  case PlyType::UInt8:
+    return 1;
+  case PlyType::Int16:
+  case PlyType::UInt16:
+    return 2;
+  case PlyType::Int32:
+  case PlyType::UInt32:
+  case PlyType::Float32:
+    return 4;
+  case PlyType::Float64:
+    return 8;
+  }
+  return 0;
+}
+
+/////////////////////////////////////////////////
+bool FitsInPlyBody(std::size_t offset, std::size_t count, std::size_t stride,
+                   std::size_t size) {
+  if (offset > size)
+    return false;
+  return stride == 0 || count <= (size - offset) / stride;
+}
+
+/////////////////////////////////////////////////
+std::optional<std::size_t>
+PlyElement::FindProperty(std::string_view name) const {
+  for (size_t i = 0; i < m_properties.size(); ++i) {
+    if (m_properties[i].m_name == name)
+      return i;
+  }
+  return std::nullopt;
+}
+
+/////////////////////////////////////////////////
+std::optional<std::size_t> PlyElement::GetFixedStride() const {
+  std::size_t stride = 0;
+  for (const auto &property : m_properties) {
+    if (property.m_is_list)
+      return std::nullopt;
+    stride += GetPlyTypeSize(property.m_type);
+  }
+  return stride;
+}
+
+/////////////////////////////////////////////////
+std::optional<std::size_t>
+PlyHeader::FindElement(std::string_view name) const {
+  for (size_t i = 0; i < m_elements.size(); ++i) {
+    if (m_elements[i].m_name == name)
+      return i;
+  }
+  return std::nullopt;
+}
+
+/////////////////////////////////////////////////
+PlyHeader ParsePlyHeader(std::string_view file_text) {
+
+  PlyHeader header;
+  bool seen_magic = false;
+  bool seen_format = false;
+  size_t position = 0;
+
+  while (position < file_text.size()) {
+    size_t line_end = file_text.find('\n', position);
+    if (line_end == std::string_view::npos) {
+      throw std::runtime_error("PLY header is missing end_header.");
+    }
+    std::string_view line = file_text.substr(position, line_end - position);
+    position = line_end + 1;
+
+    std::vector<std::string_view> tokens = Tokenise(line);
+    if (tokens.empty())
+      continue;
+
+    if (!seen_magic) {
+      if (tokens[0] != "ply")
+        throw std::runtime_error("File does not start with the PLY magic.");
+      seen_magic = true;
+      continue;
+    }
+
+    if (tokens[0] == "format") {
+      if (tokens.size() < 2)
+        throw std::runtime_error("Malformed PLY format line.");
+      if (tokens[1] == "ascii")
+        header.m_format = PlyFormat::Ascii;
+      else if (tokens[1] == "binary_little_endian")
+        header.m_format = PlyFormat::BinaryLittleEndian;
+      else if (tokens[1] == "binary_big_endian")
+        header.m_format = PlyFormat::BinaryBigEndian;
+      else
+        throw std::runtime_error("Unknown PLY format: " +
+                                 std::string(tokens[1]));
+      seen_format = true;
+    } else if (tokens[0] == "element") {
+      if (tokens.size() < 3)
+        throw std::runtime_error("Malformed PLY element line.");
+      PlyElement element;
+      element.m_name = std::string(tokens[1]);
+      auto [end, error] = std::from_chars(
+          tokens[2].data(), tokens[2].data() + tokens[2].size(),
+          element.m_count);
+      if (error != std::errc())
+        throw std::runtime_error("Malformed PLY element count.");
+      header.m_elements.push_back(std::move(element));
+    } else if (tokens[0] == "property") {
+      if (header.m_elements.empty())
+        throw std::runtime_error("PLY property declared before any element.");
+      PlyProperty property;
+      if (tokens.size() >= 5 && tokens[1] == "list") {
+        property.m_is_list = true;
+        property.m_list_count_type = ParsePlyType(tokens[2]);
+        property.m_type = ParsePlyType(tokens[3]);
+        property.m_name = std::string(tokens[4]);
+      } else if (tokens.size() >= 3) {
+        property.m_type = ParsePlyType(tokens[1]);
+        property.m_name = std::string(tokens[2]);
+      } else {
+        throw std::runtime_error("Malformed PLY property line.");
+      }
+      header.m_elements.back().m_properties.push_back(std::move(property));
+    } else if (tokens[0] == "end_header") {
+      if (!seen_format)
+        throw std::runtime_error("PLY header has no format line.");
+      header.m_body_offset = position;
+      if (header.m_format != PlyFormat::Ascii)
+        ComputeBinaryOffsets(header);
+      return header;
+    }
+    // "comment" and "obj_info" lines carry nothing we need
+  }
+
+  throw std::runtime_error("PLY header is missing end_header.");
+}
+
+} // namespace projection_generator
@@ -0,0 +1,158 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the PLY header description and parser
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief Storage format declared on the "format" line of a PLY header
+/////////////////////////////////////////////////
+enum class PlyFormat { Ascii, BinaryLittleEndian, BinaryBigEndian };
+
+/////////////////////////////////////////////////
+/// @brief Scalar types a PLY property (or list count) can have
+/////////////////////////////////////////////////
+enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+/////////////////////////////////////////////////
+/// @brief Size in bytes of a PLY scalar type in the binary formats
+/////////////////////////////////////////////////
+std::size_t GetPlyTypeSize(PlyType type);
+
+/////////////////////////////////////////////////
+/// @brief Whether count records of stride bytes starting at offset end
+/// within size bytes, worked out so that a corrupt count cannot overflow
+/////////////////////////////////////////////////
+bool FitsInPlyBody(std::size_t offset, std::size_t count, std::size_t stride,
+                   std::size_t size);
+
+/////////////////////////////////////////////////
+/// @struct PlyProperty
+/// @brief A single "property" line of a PLY header
+/////////////////////////////////////////////////
+struct PlyProperty {
+  std::string m_name;
+
+  /////////////////////////////////////////////////
+  /// @brief Type of the value, or of each list entry for list properties
+  /////////////////////////////////////////////////
+  PlyType m_type;
+
+  bool m_is_list{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Type of the leading count for list properties
+  /////////////////////////////////////////////////
+  PlyType m_list_count_type{PlyType::UInt8};
+
+  /////////////////////////////////////////////////
+  /// @brief Byte offset of the value inside a binary record, std::nullopt
+  /// for list properties and anything after one
+  /////////////////////////////////////////////////
+  std::optional<std::size_t> m_record_offset;
+};
+
+/////////////////////////////////////////////////
+/// @struct PlyElement
+/// @brief An "element" block of a PLY header and its properties
+/////////////////////////////////////////////////
+struct PlyElement {
+  std::string m_name;
+
+  std::size_t m_count{0};
+
+  std::vector<PlyProperty> m_properties;
+
+  /////////////////////////////////////////////////
+  /// @brief Byte offset of the first record in a binary file, std::nullopt
+  /// for ascii files or when an earlier element has list properties
+  /////////////////////////////////////////////////
+  std::optional<std::size_t> m_file_offset;
+
+  /////////////////////////////////////////////////
+  /// @brief Index of the named property, if the element has it
+  /////////////////////////////////////////////////
+  std::optional<std::size_t> FindProperty(std::string_view name) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Byte size of one binary record, or std::nullopt if the element
+  /// contains list properties and so has no fixed size
+  /////////////////////////////////////////////////
+  std::optional<std::size_t> GetFixedStride() const;
+};
+
+/////////////////////////////////////////////////
+/// @struct PlyHeader
+/// @brief Everything declared between "ply" and "end_header"
+/////////////////////////////////////////////////
+struct PlyHeader {
+  PlyFormat m_format{PlyFormat::Ascii};
+
+  std::vector<PlyElement> m_elements;
+
+  /////////////////////////////////////////////////
+  /// @brief Byte offset of the first body byte (just after "end_header\n")
+  /////////////////////////////////////////////////
+  std::size_t m_body_offset{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Index of the named element, if the file declares it
+  /////////////////////////////////////////////////
+  std::optional<std::size_t> FindElement(std::string_view name) const;
+};
+
+/////////////////////////////////////////////////
+/// @struct PlyBounds
+/// @brief Axis aligned box around the vertex positions of a PLY file
+/////////////////////////////////////////////////
+struct PlyBounds {
+  std::array<float, 3> m_min;
+  std::array<float, 3> m_max;
+};
+
+/////////////////////////////////////////////////
+/// @struct PlyProbe
+/// @brief Cheap description of a PLY file for scheduling, see
+/// DataLoader::ProbePlyFile
+/////////////////////////////////////////////////
+struct PlyProbe {
+  PlyHeader m_header;
+
+  std::uintmax_t m_file_size{0};
+
+  std::size_t m_num_vertices{0};
+
+  std::size_t m_num_faces{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Vertex bounds, only available for binary files
+  /////////////////////////////////////////////////
+  std::optional<PlyBounds> m_bounds;
+};
+
+/////////////////////////////////////////////////
+/// @brief Parse the header at the start of a PLY file, throws
+/// std::runtime_error if the header is malformed
+///
+/// @param file_text The file contents (only the header part is read)
+/////////////////////////////////////////////////
+PlyHeader ParsePlyHeader(std::string_view file_text);
+
+} // namespace projection_generator
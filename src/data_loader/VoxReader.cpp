@@ -0,0 +1,273 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the VoxReader class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "VoxReader.h"
+#include "MappedFile.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Palette MagicaVoxel uses when a file has no RGBA chunk: a 6x6x6
+/// color cube without black, then red, green, blue and grey ramps
+/////////////////////////////////////////////////
+std::array<sf::Color, 256> GetDefaultPalette() {
+  constexpr std::array<std::uint8_t, 6> kCubeLevels{0xff, 0xcc, 0x99,
+                                                    0x66, 0x33, 0x00};
+  constexpr std::array<std::uint8_t, 10> kRampLevels{
+      0xee, 0xdd, 0xbb, 0xaa, 0x88, 0x77, 0x55, 0x44, 0x22, 0x11};
+
+  std::array<sf::Color, 256> palette{};
+  size_t index = 1;
+  for (const std::uint8_t red : kCubeLevels) {
+    for (const std::uint8_t green : kCubeLevels) {
+      for (const std::uint8_t blue : kCubeLevels) {
+        if (red == 0 && green == 0 && blue == 0)
+          continue;
+        palette[index++] = sf::Color(red, green, blue);
+      }
+    }
+  }
+  for (const std::uint8_t level : kRampLevels)
+    palette[index++] = sf::Color(level, 0, 0);
+  for (const std::uint8_t level : kRampLevels)
+    palette[index++] = sf::Color(0, level, 0);
+  for (const std::uint8_t level : kRampLevels)
+    palette[index++] = sf::Color(0, 0, level);
+  for (const std::uint8_t level : kRampLevels)
+    palette[index++] = sf::Color(level, level, level);
+  return palette;
+}
+
+/////////////////////////////////////////////////
+/// @brief Bounds checked little endian reader over the mapped .vox bytes
+/////////////////////////////////////////////////
+struct VoxCursor {
+  const std::byte *m_position;
+  const std::byte *m_end;
+
+  const std::byte *Take(std::size_t num_bytes) {
+    if (static_cast<std::size_t>(m_end - m_position) < num_bytes) {
+      throw std::runtime_error(".vox file is truncated.");
+    }
+    const std::byte *start = m_position;
+    m_position += num_bytes;
+    return start;
+  }
+
+  std::int32_t ReadInt() {
+    std::int32_t value;
+    std::memcpy(&value, Take(sizeof(value)), sizeof(value));
+    return value;
+  }
+
+  std::string_view ReadId() {
+    return {reinterpret_cast<const char *>(Take(4)), 4};
+  }
+};
+
+/////////////////////////////////////////////////
+/// @brief The parts of a .vox file needed to mesh its first model
+/////////////////////////////////////////////////
+struct VoxModel {
+  std::array<std::int32_t, 3> m_size{0, 0, 0};
+
+  /////////////////////////////////////////////////
+  /// @brief Palette index per cell, x fastest, 0 for empty cells
+  /////////////////////////////////////////////////
+  std::vector<std::uint8_t> m_cells;
+
+  std::array<sf::Color, 256> m_palette = GetDefaultPalette();
+
+  size_t m_num_models{0};
+};
+
+/////////////////////////////////////////////////
+VoxModel ReadVoxModel(const MappedFile &file) {
+
+  VoxCursor cursor{file.GetData(), file.GetData() + file.GetSize()};
+  if (cursor.ReadId() != "VOX ") {
+    throw std::runtime_error("File does not start with the .vox magic.");
+  }
+  cursor.ReadInt(); // version
+
+  if (cursor.ReadId() != "MAIN") {
+    throw std::runtime_error(".vox file has no MAIN chunk.");
+  }
+  cursor.Take(static_cast<std::size_t>(cursor.ReadInt()));
+  const auto children_size = static_cast<std::size_t>(cursor.ReadInt());
+  VoxCursor children{cursor.Take(children_size), cursor.m_position};
+
+  VoxModel model;
+  bool have_voxels = false;
+
+  while (children.m_position < children.m_end) {
+    const std::string_view id = children.ReadId();
+    const auto content_size = static_cast<std::size_t>(children.ReadInt());
+    const auto nested_size = static_cast<std::size_t>(children.ReadInt());
+    VoxCursor content{children.Take(content_size), children.m_position};
+    children.Take(nested_size);
+
+    if (id == "SIZE") {
+      ++model.m_num_models;
+      if (model.m_num_models > 1)
+        continue;
+      for (auto &extent : model.m_size) {
+        extent = content.ReadInt();
+        if (extent <= 0 || extent > 2048)
+          throw std::runtime_error(".vox model has an invalid size.");
+      }
+      model.m_cells.assign(static_cast<size_t>(model.m_size[0]) *
+                               model.m_size[1] * model.m_size[2],
+                           0);
+    } else if (id == "XYZI") {
+      if (have_voxels || model.m_cells.empty())
+        continue;
+      have_voxels = true;
+      const auto num_voxels = static_cast<std::size_t>(content.ReadInt());
+      const std::byte *voxels = content.Take(num_voxels * 4);
+      for (size_t i = 0; i < num_voxels; ++i) {
+        const auto x = std::to_integer<std::int32_t>(voxels[i * 4 + 0]);
+        const auto y = std::to_integer<std::int32_t>(voxels[i * 4 + 1]);
+        const auto z = std::to_integer<std::int32_t>(voxels[i * 4 + 2]);
+        const auto color = std::to_integer<std::uint8_t>(voxels[i * 4 + 3]);
+        if (x >= model.m_size[0] || y >= model.m_size[1] ||
+            z >= model.m_size[2]) {
+          throw std::runtime_error(".vox voxel lies outside its model.");
+        }
+        model.m_cells[(static_cast<size_t>(z) * model.m_size[1] + y) *
+                          model.m_size[0] +
+                      x] = color;
+      }
+    } else if (id == "RGBA") {
+      // entry i of the chunk is the color of palette index i + 1
+      const std::byte *entries = content.Take(256 * 4);
+      for (size_t i = 0; i + 1 < 256; ++i) {
+        model.m_palette[i + 1] =
+            sf::Color(std::to_integer<std::uint8_t>(entries[i * 4 + 0]),
+                      std::to_integer<std::uint8_t>(entries[i * 4 + 1]),
+                      std::to_integer<std::uint8_t>(entries[i * 4 + 2]),
+                      std::to_integer<std::uint8_t>(entries[i * 4 + 3]));
+      }
+    }
+    // scene graph, material and layer chunks do not affect the mesh
+  }
+
+  if (!have_voxels) {
+    throw std::runtime_error(".vox file has no SIZE/XYZI model.");
+  }
+  return model;
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+Fragment3D VoxReader::Read(const std::filesystem::path &file_path,
+                           const Fragment3DOptions &options) {
+
+  MappedFile file(file_path);
+  const VoxModel model = ReadVoxModel(file);
+  if (model.m_num_models > 1) {
+    std::cerr << "[ERROR] " << file_path.string() << " holds "
+              << model.m_num_models << " models, only the first is meshed."
+              << std::endl;
+  }
+
+  const std::array<std::int32_t, 3> &size = model.m_size;
+  auto cell_at = [&](std::int32_t x, std::int32_t y,
+                     std::int32_t z) -> std::uint8_t {
+    if (x < 0 || y < 0 || z < 0 || x >= size[0] || y >= size[1] ||
+        z >= size[2])
+      return 0;
+    return model.m_cells[(static_cast<size_t>(z) * size[1] + y) * size[0] + x];
+  };
+
+  std::vector<Vertex3> vertices;
+  std::vector<std::array<size_t, 4>> faces;
+
+  // a corner is shared by every face of the same color that touches it
+  std::unordered_map<std::uint64_t, size_t> corner_ids;
+  auto corner_for = [&](std::array<std::int32_t, 3> corner,
+                        std::uint8_t color_index) {
+    const std::uint64_t key =
+        (((static_cast<std::uint64_t>(corner[2]) * (size[1] + 1) + corner[1]) *
+              (size[0] + 1) +
+          corner[0])
+         << 8) |
+        color_index;
+    auto [found, inserted] = corner_ids.try_emplace(key, vertices.size());
+    if (inserted) {
+      const glm::vec3 position(
+          (static_cast<float>(corner[0]) - static_cast<float>(size[0]) / 2.0f) *
+              kVoxelSize,
+          (static_cast<float>(corner[1]) - static_cast<float>(size[1]) / 2.0f) *
+              kVoxelSize,
+          static_cast<float>(corner[2]) * kVoxelSize);
+      vertices.emplace_back(position, model.m_palette[color_index]);
+    }
+    return found->second;
+  };
+
+  for (std::int32_t z = 0; z < size[2]; ++z) {
+    for (std::int32_t y = 0; y < size[1]; ++y) {
+      for (std::int32_t x = 0; x < size[0]; ++x) {
+        const std::uint8_t color_index = cell_at(x, y, z);
+        if (color_index == 0)
+          continue;
+        const std::array<std::int32_t, 3> cell{x, y, z};
+
+        for (int axis = 0; axis < 3; ++axis) {
+          for (const int direction : {-1, 1}) {
+            std::array<std::int32_t, 3> neighbour = cell;
+            neighbour[axis] += direction;
+            if (cell_at(neighbour[0], neighbour[1], neighbour[2]) != 0)
+              continue;
+
+            // corners walk the face plane so the right hand normal points
+            // out of the voxel, matching the winding of the PLY export
+            const int u = (axis + 1) % 3;
+            const int v = (axis + 2) % 3;
+            std::array<std::int32_t, 3> origin = cell;
+            if (direction > 0)
+              origin[axis] += 1;
+            std::array<std::array<std::int32_t, 3>, 4> corners{origin, origin,
+                                                               origin, origin};
+            corners[1][u] += 1;
+            corners[2][u] += 1;
+            corners[2][v] += 1;
+            corners[3][v] += 1;
+            if (direction < 0)
+              std::swap(corners[1], corners[3]);
+
+            faces.push_back({corner_for(corners[0], color_index),
+                             corner_for(corners[1], color_index),
+                             corner_for(corners[2], color_index),
+                             corner_for(corners[3], color_index)});
+          }
+        }
+      }
+    }
+  }
+
+  std::cout << "[DEBUG] Meshed " << faces.size() << " exposed faces with "
+            << vertices.size() << " shared vertices from .vox." << std::endl;
+
+  return Fragment3D{std::move(vertices), std::move(faces), options};
+}
+
+} // namespace projection_generator
@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the VoxReader class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "Fragment3D.h"
+#include <filesystem>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class VoxReader
+/// @brief Reader for MagicaVoxel .vox files that meshes the voxels directly.
+///
+/// The SIZE, XYZI and RGBA chunks are read into an occupancy grid and a
+/// palette, and only faces between a filled and an empty cell are emitted.
+/// Corners are shared between faces of the same color, so a surface costs
+/// roughly one vertex per face instead of the four the PLY export writes.
+/// Positions follow the MagicaVoxel PLY export: 0.1 units per voxel, centred
+/// on x and y, and z starting at 0.
+/////////////////////////////////////////////////
+class VoxReader {
+public:
+  /////////////////////////////////////////////////
+  /// @brief Edge length of one voxel in fragment units
+  /////////////////////////////////////////////////
+  static constexpr float kVoxelSize = 0.1f;
+
+  VoxReader() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Read the first model of a .vox file into a Fragment3D, throws
+  /// std::runtime_error on malformed input
+  ///
+  /// @param file_path Path of the .vox file
+  /// @param options Processing applied when the Fragment3D is built
+  /////////////////////////////////////////////////
+  Fragment3D Read(const std::filesystem::path &file_path,
+                  const Fragment3DOptions &options = {});
+};
+} // namespace projection_generator
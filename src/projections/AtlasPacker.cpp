@@ -0,0 +1,355 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the AtlasPacker class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "AtlasPacker.h"
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <locale>
+#include <stdexcept>
+#include <string>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Run of the skyline at one height
+/////////////////////////////////////////////////
+struct SkylineSegment {
+  unsigned m_x{0};
+
+  unsigned m_y{0};
+
+  unsigned m_width{0};
+};
+
+/////////////////////////////////////////////////
+/// @class Skyline
+/// @brief Bottom-left skyline packer of a bin with a fixed width and an
+/// open height. Each rectangle goes where its top edge is lowest, the
+/// leftmost such place on a tie, so the result depends only on the
+/// rectangles and their order.
+/////////////////////////////////////////////////
+class Skyline {
+private:
+  unsigned m_width;
+
+  /////////////////////////////////////////////////
+  /// @brief Left to right, covering [0, m_width) without gaps
+  /////////////////////////////////////////////////
+  std::vector<SkylineSegment> m_segments;
+
+  unsigned m_height{0};
+
+public:
+  explicit Skyline(unsigned width)
+      : m_width(width), m_segments{{0, 0, width}} {}
+
+  /////////////////////////////////////////////////
+  /// @brief Place a rectangle no wider than the bin
+  ///
+  /// @return Its top left corner
+  /////////////////////////////////////////////////
+  sf::Vector2u Insert(unsigned width, unsigned height) {
+    size_t best = 0;
+    unsigned best_y = 0;
+    std::uint64_t best_top = std::numeric_limits<std::uint64_t>::max();
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+      const unsigned x = m_segments[i].m_x;
+      if (width > m_width - x)
+        break;
+      // the rectangle rests on the highest segment under it
+      unsigned y = 0;
+      for (size_t j = i;
+           j < m_segments.size() && m_segments[j].m_x < x + width; ++j)
+        y = std::max(y, m_segments[j].m_y);
+      const std::uint64_t top = std::uint64_t{y} + height;
+      if (top < best_top) {
+        best = i;
+        best_y = y;
+        best_top = top;
+      }
+    }
+
+    // the new segment replaces the part of the skyline it covers
+    const unsigned x = m_segments[best].m_x;
+    const unsigned right = x + width;
+    size_t last = best;
+    while (last < m_segments.size() &&
+           m_segments[last].m_x + m_segments[last].m_width <= right)
+      ++last;
+    if (last < m_segments.size() && m_segments[last].m_x < right) {
+      m_segments[last].m_width -= right - m_segments[last].m_x;
+      m_segments[last].m_x = right;
+    }
+    const unsigned top = best_y + height;
+    m_segments.erase(m_segments.begin() + static_cast<std::ptrdiff_t>(best),
+                     m_segments.begin() + static_cast<std::ptrdiff_t>(last));
+    m_segments.insert(m_segments.begin() + static_cast<std::ptrdiff_t>(best),
+                      {x, top, width});
+
+    // neighbours at the same height become one segment
+    for (size_t i = m_segments.size() - 1; i > 0; --i) {
+      if (m_segments[i - 1].m_y == m_segments[i].m_y) {
+        m_segments[i - 1].m_width += m_segments[i].m_width;
+        m_segments.erase(m_segments.begin() + static_cast<std::ptrdiff_t>(i));
+      }
+    }
+    m_height = std::max(m_height, top);
+    return {x, best_y};
+  }
+
+  unsigned GetHeight() const { return m_height; }
+};
+
+/////////////////////////////////////////////////
+/// @brief Pixels a length in projected units covers when drawn
+/////////////////////////////////////////////////
+std::uint64_t GetPixelExtent(float length, float pixels_per_unit) {
+  const double pixels = std::ceil(static_cast<double>(length) *
+                                  static_cast<double>(pixels_per_unit));
+  if (!(pixels >= 0.0))
+    return 0;
+  return static_cast<std::uint64_t>(
+      std::min(pixels, static_cast<double>(std::uint32_t{1} << 31)));
+}
+
+/////////////////////////////////////////////////
+/// @brief Quote text as a JSON string, escaping quotes, backslashes and
+/// control characters. Other bytes, such as UTF-8, are kept as they are.
+/////////////////////////////////////////////////
+std::string QuoteJson(const std::string &text) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+  std::string quoted = "\"";
+  for (const char c : text) {
+    const auto byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+      quoted += c;
+    } else if (byte < 0x20) {
+      quoted += "\\u00";
+      quoted += kHexDigits[byte >> 4];
+      quoted += kHexDigits[byte & 0xf];
+    } else {
+      quoted += c;
+    }
+  }
+  quoted += '"';
+  return quoted;
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+AtlasPacker::AtlasPacker(ThreadPool &thread_pool)
+    : m_thread_pool(thread_pool) {}
+
+/////////////////////////////////////////////////
+void AtlasPacker::SetPixelsPerUnit(float pixels_per_unit) {
+  if (!(pixels_per_unit > 0.0f) || !std::isfinite(pixels_per_unit))
+    throw std::runtime_error("Atlas scale must be positive.");
+  m_pixels_per_unit = pixels_per_unit;
+}
+
+/////////////////////////////////////////////////
+void AtlasPacker::SetPadding(unsigned padding) { m_padding = padding; }
+
+/////////////////////////////////////////////////
+void AtlasPacker::SetMaxSize(unsigned max_size) {
+  m_max_size = std::max(max_size, 1u);
+}
+
+/////////////////////////////////////////////////
+Atlas AtlasPacker::Pack(const Projector &projector) const {
+  const size_t num_shapes = projector.GetShapeCount();
+  Atlas atlas;
+  atlas.m_pixels_per_unit = m_pixels_per_unit;
+  atlas.m_regions.resize(num_shapes);
+
+  // trim every shape to its bounds, leaving empty ones out of the packing
+  std::vector<size_t> order;
+  std::uint64_t widest = 0;
+  std::uint64_t area = 0;
+  for (size_t i = 0; i < num_shapes; ++i) {
+    AtlasRegion &region = atlas.m_regions[i];
+    region.m_index = i;
+    if (projector.GetShape(i).empty())
+      continue;
+    region.m_bounds = projector.GetShapeBounds(i);
+    const std::uint64_t width =
+        GetPixelExtent(region.m_bounds.size.x, m_pixels_per_unit);
+    const std::uint64_t height =
+        GetPixelExtent(region.m_bounds.size.y, m_pixels_per_unit);
+    if (width == 0 || height == 0)
+      continue;
+    if (width + m_padding > m_max_size || height + m_padding > m_max_size) {
+      throw std::runtime_error("Shape " + std::to_string(i) +
+                               " is larger than the atlas size limit.");
+    }
+    region.m_rect.size = {static_cast<int>(width), static_cast<int>(height)};
+    widest = std::max(widest, width + m_padding);
+    area += (width + m_padding) * (height + m_padding);
+    order.push_back(i);
+  }
+
+  // tallest first keeps the skyline flat, and the index settles ties so
+  // the order never depends on how the sort breaks them
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    const sf::Vector2i &size_a = atlas.m_regions[a].m_rect.size;
+    const sf::Vector2i &size_b = atlas.m_regions[b].m_rect.size;
+    if (size_a.y != size_b.y)
+      return size_a.y > size_b.y;
+    if (size_a.x != size_b.x)
+      return size_a.x > size_b.x;
+    return a < b;
+  });
+
+  const std::uint64_t side = static_cast<std::uint64_t>(
+      std::ceil(std::sqrt(static_cast<double>(area))));
+  const std::uint64_t width = std::max({widest, side, std::uint64_t{1}});
+  const unsigned atlas_width = static_cast<unsigned>(
+      std::min<std::uint64_t>(std::bit_ceil(width), m_max_size));
+  Skyline skyline(atlas_width);
+  for (const size_t i : order) {
+    AtlasRegion &region = atlas.m_regions[i];
+    const sf::Vector2u corner = skyline.Insert(
+        static_cast<unsigned>(region.m_rect.size.x) + m_padding,
+        static_cast<unsigned>(region.m_rect.size.y) + m_padding);
+    region.m_rect.position = {static_cast<int>(corner.x),
+                              static_cast<int>(corner.y)};
+  }
+  const unsigned atlas_height = std::max(skyline.GetHeight(), 1u);
+  if (atlas_height > m_max_size) {
+    throw std::runtime_error("Snapshots do not fit in an atlas of " +
+                             std::to_string(m_max_size) + " pixels.");
+  }
+
+  // move every shape into its region, so one draw call fills the atlas
+  std::vector<size_t> offsets(num_shapes + 1, 0);
+  bool use_depth = true;
+  for (size_t i = 0; i < num_shapes; ++i) {
+    const bool packed = atlas.m_regions[i].m_rect.size.x > 0;
+    offsets[i + 1] = offsets[i] + (packed ? projector.GetShape(i).size() : 0);
+    if (packed && projector.GetShapeDepth(i).empty())
+      use_depth = false;
+  }
+  std::vector<sf::Vertex> vertices(offsets.back());
+  std::vector<float> depth(use_depth ? offsets.back() : 0);
+  m_thread_pool.ParallelFor(0, num_shapes, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const AtlasRegion &region = atlas.m_regions[i];
+      if (region.m_rect.size.x == 0)
+        continue;
+      const std::span<const sf::Vertex> shape = projector.GetShape(i);
+      const sf::Vector2f corner(static_cast<float>(region.m_rect.position.x),
+                                static_cast<float>(region.m_rect.position.y));
+      for (size_t k = 0; k < shape.size(); ++k) {
+        sf::Vertex &vertex = vertices[offsets[i] + k];
+        vertex = shape[k];
+        vertex.position =
+            corner + (shape[k].position - region.m_bounds.position) *
+                         m_pixels_per_unit;
+      }
+      if (use_depth) {
+        const std::span<const float> shape_depth = projector.GetShapeDepth(i);
+        std::copy(shape_depth.begin(), shape_depth.end(),
+                  depth.begin() + static_cast<std::ptrdiff_t>(offsets[i]));
+      }
+    }
+  });
+
+  SoftwareRasterizer rasterizer({atlas_width, atlas_height}, m_thread_pool);
+  rasterizer.Draw(vertices, depth,
+                  sf::FloatRect({0.0f, 0.0f},
+                                {static_cast<float>(atlas_width),
+                                 static_cast<float>(atlas_height)}));
+  atlas.m_image = rasterizer.GetImage();
+
+  atlas.m_coverage = static_cast<double>(area) /
+                     (static_cast<double>(atlas_width) * atlas_height);
+  return atlas;
+}
+
+/////////////////////////////////////////////////
+std::vector<Atlas>
+AtlasPacker::PackFragmentsAboutY(std::span<const Fragment3D> fragments,
+                                 const size_t rotation_intervals) const {
+  std::vector<Atlas> atlases(fragments.size());
+  m_thread_pool.ParallelFor(
+      0, fragments.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          Projector projector(m_thread_pool);
+          projector.SetKeepDepth(true);
+          projector.SetSweepLogging(false);
+          projector.RotateFragmentAboutY(fragments[i], rotation_intervals);
+          atlases[i] = Pack(projector);
+        }
+      });
+  return atlases;
+}
+
+/////////////////////////////////////////////////
+void WriteAtlas(const Atlas &atlas, const std::filesystem::path &image_path) {
+  if (!atlas.m_image.saveToFile(image_path)) {
+    throw std::runtime_error("Could not write atlas image: " +
+                             image_path.string());
+  }
+
+  std::filesystem::path metadata_path = image_path;
+  metadata_path.replace_extension(".json");
+  std::ofstream metadata(metadata_path, std::ios::trunc);
+  if (!metadata) {
+    throw std::runtime_error("Could not open atlas metadata: " +
+                             metadata_path.string());
+  }
+  // the same atlas always gives the same text, whatever the user's locale
+  metadata.imbue(std::locale::classic());
+  metadata.precision(std::numeric_limits<float>::max_digits10);
+
+  const sf::Vector2u size = atlas.m_image.getSize();
+  const float width = static_cast<float>(std::max(size.x, 1u));
+  const float height = static_cast<float>(std::max(size.y, 1u));
+  metadata << "{\n"
+           << "  \"image\": " << QuoteJson(image_path.filename().string())
+           << ",\n"
+           << "  \"width\": " << size.x << ",\n"
+           << "  \"height\": " << size.y << ",\n"
+           << "  \"pixels_per_unit\": " << atlas.m_pixels_per_unit << ",\n"
+           << "  \"regions\": [";
+  for (size_t i = 0; i < atlas.m_regions.size(); ++i) {
+    const AtlasRegion &region = atlas.m_regions[i];
+    const sf::IntRect &rect = region.m_rect;
+    metadata << (i == 0 ? "\n" : ",\n") << "    {\"index\": " << region.m_index
+             << ", \"x\": " << rect.position.x
+             << ", \"y\": " << rect.position.y
+             << ", \"width\": " << rect.size.x
+             << ", \"height\": " << rect.size.y
+             << ", \"u0\": " << static_cast<float>(rect.position.x) / width
+             << ", \"v0\": " << static_cast<float>(rect.position.y) / height
+             << ", \"u1\": "
+             << static_cast<float>(rect.position.x + rect.size.x) / width
+             << ", \"v1\": "
+             << static_cast<float>(rect.position.y + rect.size.y) / height
+             << ", \"offset_x\": " << region.m_bounds.position.x
+             << ", \"offset_y\": " << region.m_bounds.position.y
+             << ", \"bounds_width\": " << region.m_bounds.size.x
+             << ", \"bounds_height\": " << region.m_bounds.size.y << "}";
+  }
+  metadata << (atlas.m_regions.empty() ? "]\n" : "\n  ]\n") << "}\n";
+  if (!metadata) {
+    throw std::runtime_error("Could not write atlas metadata: " +
+                             metadata_path.string());
+  }
+}
+
+} // namespace projection_generator
@@ -0,0 +1,148 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the AtlasPacker class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "Fragment3D.h"
+#include "Projector.h"
+#include "ThreadPool.h"
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief Where one shape of a sweep was drawn in an atlas
+/////////////////////////////////////////////////
+struct AtlasRegion {
+  /////////////////////////////////////////////////
+  /// @brief Shape of the sweep, see Projector::GetShape
+  /////////////////////////////////////////////////
+  size_t m_index{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Pixels of the atlas holding the shape, empty if the shape is
+  /// empty
+  /////////////////////////////////////////////////
+  sf::IntRect m_rect;
+
+  /////////////////////////////////////////////////
+  /// @brief Bounds of the shape in projected units, whose corner maps to
+  /// the corner of m_rect, see Projector::GetShapeBounds
+  /////////////////////////////////////////////////
+  sf::FloatRect m_bounds;
+};
+
+/////////////////////////////////////////////////
+/// @brief Every shape of a sweep drawn into one image
+/////////////////////////////////////////////////
+struct Atlas {
+  sf::Image m_image;
+
+  /////////////////////////////////////////////////
+  /// @brief Scale the shapes were drawn at
+  /////////////////////////////////////////////////
+  float m_pixels_per_unit{0.0f};
+
+  /////////////////////////////////////////////////
+  /// @brief One region per shape, in shape order
+  /////////////////////////////////////////////////
+  std::vector<AtlasRegion> m_regions;
+
+  /////////////////////////////////////////////////
+  /// @brief Share of the atlas taken by the regions and their padding,
+  /// between 0 and 1
+  /////////////////////////////////////////////////
+  double m_coverage{0.0};
+};
+
+/////////////////////////////////////////////////
+/// @class AtlasPacker
+/// @brief Draws the shapes of rotation sweeps into texture atlases without
+/// a window.
+///
+/// Each shape is trimmed to its bounds and the rectangles are packed with a
+/// bottom-left skyline, tallest first, into an atlas whose width is the
+/// smallest power of two near the square holding their area. All shapes
+/// are then drawn in one pass by SoftwareRasterizer. The order of the
+/// rectangles, and so the whole atlas, depends only on the shapes, which
+/// makes atlases of the same input byte for byte identical whatever the
+/// thread count.
+/////////////////////////////////////////////////
+class AtlasPacker {
+private:
+  ThreadPool &m_thread_pool;
+
+  float m_pixels_per_unit{100.0f};
+
+  /////////////////////////////////////////////////
+  /// @brief Transparent pixels kept between neighbouring regions, so
+  /// filtered lookups do not bleed into the next shape
+  /////////////////////////////////////////////////
+  unsigned m_padding{1};
+
+  unsigned m_max_size{8192};
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Constructor
+  ///
+  /// @param thread_pool Pool fragments are packed and atlases drawn on
+  /////////////////////////////////////////////////
+  explicit AtlasPacker(ThreadPool &thread_pool = ThreadPool::GetShared());
+
+  /////////////////////////////////////////////////
+  /// @brief Pixels per projected unit the shapes are drawn at, 100 by
+  /// default, which matches the zoomed view of the preview window
+  /////////////////////////////////////////////////
+  void SetPixelsPerUnit(float pixels_per_unit);
+
+  void SetPadding(unsigned padding);
+
+  /////////////////////////////////////////////////
+  /// @brief Largest width or height of an atlas, 8192 by default. Packing
+  /// throws std::runtime_error if the shapes do not fit.
+  /////////////////////////////////////////////////
+  void SetMaxSize(unsigned max_size);
+
+  /////////////////////////////////////////////////
+  /// @brief Pack and draw every shape the projector holds. Depth is used
+  /// if every shape kept it, see Projector::SetKeepDepth.
+  /////////////////////////////////////////////////
+  Atlas Pack(const Projector &projector) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Sweep every fragment about Y and pack each sweep into its own
+  /// atlas, fragments in parallel. Depth is kept, so the atlases show only
+  /// the nearest surfaces. Nothing is printed; callers report
+  /// Atlas::m_coverage themselves.
+  ///
+  /// @return One atlas per fragment, in fragment order
+  /////////////////////////////////////////////////
+  std::vector<Atlas>
+  PackFragmentsAboutY(std::span<const Fragment3D> fragments,
+                      const size_t rotation_intervals) const;
+};
+
+/////////////////////////////////////////////////
+/// @brief Save the atlas image as a PNG and its regions as JSON next to
+/// it, with the extension replaced by .json. Throws std::runtime_error if
+/// either cannot be written.
+///
+/// Every region lists its pixel rectangle, its UVs and the offset and size
+/// of its shape in projected units.
+/////////////////////////////////////////////////
+void WriteAtlas(const Atlas &atlas, const std::filesystem::path &image_path);
+} // namespace projection_generator
@@ -0,0 +1,517 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Layout of compressed vertex files and the header-only
+/// CompressedVertexFileReader
+///
+/// A compressed vertex file holds the same snapshots as a vertex file (see
+/// VertexFile.h), written by SnapshotWriter with
+/// VertexFileEncoding::Compressed:
+///
+/// - a CompressedVertexFileHeader at offset 0
+/// - per snapshot, its encoded channels back to back
+/// - the palette, every distinct vertex color of the file
+/// - the table of CompressedVertexFileEntry, one per snapshot in sweep order
+///
+/// Positions, and depths if kept, are quantized to 16 bit fixed point
+/// between the snapshot's bounds, so they come back within half a step of
+/// 1 / 65535 of the extent, plus the rounding of the result to float.
+/// Colors are replaced by their palette index and come back exactly.
+///
+/// Every channel holds one unsigned value per vertex. Each value is stored
+/// as the zigzag coded difference from the one before (starting from 0),
+/// written as a LEB128 varint, and the varint bytes are then either kept
+/// as they are or entropy coded with a static order 0 rANS coder:
+///
+/// - ChannelCoding (1 byte), varint number of varint bytes
+/// - Raw: the bytes
+/// - Rans: varint number of distinct bytes, each as the byte and its
+///   varint frequency out of kRansTotal, then the varint payload size and
+///   the payload
+///
+/// No frequency is above kRansMaxFrequency, so every coded byte costs some
+/// payload and a snapshot cannot claim more vertices than its size allows,
+/// see kMaxVerticesPerStoredByte.
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "VertexFile.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace projection_generator {
+
+constexpr std::array<char, 8> kCompressedVertexFileMagic{'P', 'G', 'V', 'E',
+                                                         'R', 'T', 'E', 'Z'};
+
+/////////////////////////////////////////////////
+/// @brief Bump whenever the layout or the coding changes
+/////////////////////////////////////////////////
+constexpr std::uint32_t kCompressedVertexFileVersion = 2;
+
+/////////////////////////////////////////////////
+/// @brief Largest quantized position or depth
+/////////////////////////////////////////////////
+constexpr std::uint32_t kQuantizedMax = 65535;
+
+/////////////////////////////////////////////////
+/// @brief rANS frequencies add up to 1 << kRansProbabilityBits
+/////////////////////////////////////////////////
+constexpr std::uint32_t kRansProbabilityBits = 12;
+
+constexpr std::uint32_t kRansTotal = 1u << kRansProbabilityBits;
+
+/////////////////////////////////////////////////
+/// @brief The rANS state is kept in [kRansLowerBound, kRansLowerBound << 8)
+/// by moving single bytes in and out
+/////////////////////////////////////////////////
+constexpr std::uint32_t kRansLowerBound = 1u << 23;
+
+/////////////////////////////////////////////////
+/// @brief Largest frequency of a byte. Each byte decoded leaves the rANS
+/// state at most about 7/8 of what it was, so a payload of n bytes holds
+/// fewer than 42 * n coded bytes.
+/////////////////////////////////////////////////
+constexpr std::uint32_t kRansMaxFrequency = kRansTotal - kRansTotal / 8;
+
+/////////////////////////////////////////////////
+/// @brief Bound on a snapshot's vertex count per byte of its channels.
+/// Every vertex has at least one varint byte in each of the x, y and color
+/// channels, and a channel of n bytes holds fewer than 42 * n varint bytes,
+/// so no complete snapshot has more than 14 vertices per byte.
+/////////////////////////////////////////////////
+constexpr std::uint64_t kMaxVerticesPerStoredByte = 16;
+
+/////////////////////////////////////////////////
+/// @brief Channels with fewer varint bytes are stored raw, as the rANS
+/// frequency table would cost more than it saves
+/////////////////////////////////////////////////
+constexpr std::size_t kMinRansBytes = 256;
+
+/////////////////////////////////////////////////
+/// @brief How the varint bytes of a channel are stored
+/////////////////////////////////////////////////
+enum class ChannelCoding : std::uint8_t { Raw = 0, Rans = 1 };
+
+/////////////////////////////////////////////////
+/// @brief Fixed header at the start of every compressed vertex file
+/////////////////////////////////////////////////
+struct CompressedVertexFileHeader {
+  std::array<char, 8> m_magic;
+  std::uint32_t m_version;
+  std::uint32_t m_byte_order;
+  std::uint64_t m_num_snapshots;
+  std::uint64_t m_table_offset;
+  std::uint64_t m_num_colors;
+  std::uint64_t m_palette_offset;
+  std::uint64_t m_file_size;
+  std::uint64_t m_reserved;
+};
+
+/////////////////////////////////////////////////
+/// @brief Where one snapshot's channels are and how to scale them back
+/////////////////////////////////////////////////
+struct CompressedVertexFileEntry {
+  /////////////////////////////////////////////////
+  /// @brief Step of the sweep, see Snapshot::m_index
+  /////////////////////////////////////////////////
+  std::uint64_t m_index;
+  std::uint64_t m_num_vertices;
+
+  /////////////////////////////////////////////////
+  /// @brief Bytes of the x, y, color and depth channels, from the start of
+  /// the file
+  /////////////////////////////////////////////////
+  std::uint64_t m_offset;
+  std::uint64_t m_size;
+
+  /////////////////////////////////////////////////
+  /// @brief Bounds the positions are quantized between, all 0 for an empty
+  /// snapshot
+  /////////////////////////////////////////////////
+  float m_min_x;
+  float m_min_y;
+  float m_max_x;
+  float m_max_y;
+
+  /////////////////////////////////////////////////
+  /// @brief Bounds the depths are quantized between
+  /////////////////////////////////////////////////
+  float m_min_depth;
+  float m_max_depth;
+
+  /////////////////////////////////////////////////
+  /// @brief 1 if the snapshot has a depth channel, 0 otherwise
+  /////////////////////////////////////////////////
+  std::uint32_t m_has_depth;
+  std::uint32_t m_reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<CompressedVertexFileHeader>);
+static_assert(std::is_trivially_copyable_v<CompressedVertexFileEntry>);
+static_assert(sizeof(CompressedVertexFileHeader) == 64);
+static_assert(sizeof(CompressedVertexFileEntry) == 64);
+
+/////////////////////////////////////////////////
+/// @brief Difference between neighbouring quantized values. Quantize and
+/// Dequantize share it and work in double, so the two directions agree.
+/////////////////////////////////////////////////
+inline double GetQuantizationStep(float min, float max) {
+  return (static_cast<double>(max) - static_cast<double>(min)) /
+         static_cast<double>(kQuantizedMax);
+}
+
+/////////////////////////////////////////////////
+/// @brief Fixed point value of v between min and max, the nearest step
+/////////////////////////////////////////////////
+inline std::uint32_t Quantize(float min, double step, float v) {
+  if (!(step > 0.0))
+    return 0;
+  const double steps =
+      std::round((static_cast<double>(v) - static_cast<double>(min)) / step);
+  return static_cast<std::uint32_t>(
+      std::clamp(steps, 0.0, static_cast<double>(kQuantizedMax)));
+}
+
+/////////////////////////////////////////////////
+/// @brief Value of a quantized position or depth
+/////////////////////////////////////////////////
+inline float Dequantize(float min, double step, std::uint32_t quantized) {
+  return static_cast<float>(static_cast<double>(min) +
+                            static_cast<double>(quantized) * step);
+}
+
+/////////////////////////////////////////////////
+/// @brief One decoded snapshot. Decoding into the same object again reuses
+/// its buffers.
+/////////////////////////////////////////////////
+struct DecodedSnapshot {
+  std::uint64_t m_index{0};
+
+  std::vector<float> m_x;
+
+  std::vector<float> m_y;
+
+  std::vector<VertexFileColor> m_colors;
+
+  /////////////////////////////////////////////////
+  /// @brief Empty if the snapshot has no depths
+  /////////////////////////////////////////////////
+  std::vector<float> m_depth;
+};
+
+/////////////////////////////////////////////////
+/// @class ChannelDecoder
+/// @brief Reads the values of one channel in order, see the file comment
+/////////////////////////////////////////////////
+class ChannelDecoder {
+private:
+  const std::uint8_t *m_position;
+
+  const std::uint8_t *m_end;
+
+  /////////////////////////////////////////////////
+  /// @brief Varint bytes the channel holds, and how many were read
+  /////////////////////////////////////////////////
+  std::uint64_t m_num_bytes{0};
+
+  std::uint64_t m_num_bytes_read{0};
+
+  ChannelCoding m_coding{ChannelCoding::Raw};
+
+  std::uint32_t m_state{0};
+
+  std::uint32_t m_value{0};
+
+  bool m_corrupt{false};
+
+  std::array<std::uint16_t, 256> m_frequencies{};
+
+  std::array<std::uint16_t, 256> m_starts{};
+
+  /////////////////////////////////////////////////
+  /// @brief Byte of every slot of the rANS state's low bits
+  /////////////////////////////////////////////////
+  std::array<std::uint8_t, kRansTotal> m_slot_symbols{};
+
+  std::uint8_t ReadStoredByte() {
+    if (m_position == m_end) {
+      m_corrupt = true;
+      return 0;
+    }
+    return *m_position++;
+  }
+
+  std::uint64_t ReadStoredVarint() {
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      const std::uint8_t byte = ReadStoredByte();
+      value |= std::uint64_t{byte & 0x7fu} << shift;
+      if ((byte & 0x80u) == 0)
+        return value;
+    }
+    m_corrupt = true;
+    return 0;
+  }
+
+  std::uint8_t ReadByte() {
+    ++m_num_bytes_read;
+    if (m_coding == ChannelCoding::Raw)
+      return ReadStoredByte();
+
+    const std::uint32_t slot = m_state & (kRansTotal - 1);
+    const std::uint8_t symbol = m_slot_symbols[slot];
+    m_state = m_frequencies[symbol] * (m_state >> kRansProbabilityBits) +
+              slot - m_starts[symbol];
+    // a corrupt state may never reach the bound, and a payload read past
+    // its end only yields zeros
+    while (m_state < kRansLowerBound && !m_corrupt)
+      m_state = (m_state << 8) | ReadStoredByte();
+    return symbol;
+  }
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Start reading the channel at the front of data
+  /////////////////////////////////////////////////
+  explicit ChannelDecoder(std::span<const std::uint8_t> data)
+      : m_position(data.data()), m_end(data.data() + data.size()) {
+    m_coding = static_cast<ChannelCoding>(ReadStoredByte());
+    m_num_bytes = ReadStoredVarint();
+    if (m_coding == ChannelCoding::Raw) {
+      if (m_num_bytes > static_cast<std::uint64_t>(m_end - m_position))
+        m_corrupt = true;
+      else
+        m_end = m_position + m_num_bytes;
+      return;
+    }
+    if (m_coding != ChannelCoding::Rans) {
+      m_corrupt = true;
+      return;
+    }
+
+    const std::uint64_t num_symbols = ReadStoredVarint();
+    std::uint32_t start = 0;
+    for (std::uint64_t i = 0; i < num_symbols && !m_corrupt; ++i) {
+      const std::uint8_t symbol = ReadStoredByte();
+      const std::uint64_t frequency = ReadStoredVarint();
+      if (frequency == 0 || frequency > kRansMaxFrequency ||
+          frequency > kRansTotal - start) {
+        m_corrupt = true;
+        return;
+      }
+      m_frequencies[symbol] = static_cast<std::uint16_t>(frequency);
+      m_starts[symbol] = static_cast<std::uint16_t>(start);
+      for (std::uint64_t slot = 0; slot < frequency; ++slot)
+        m_slot_symbols[start + slot] = symbol;
+      start += static_cast<std::uint32_t>(frequency);
+    }
+    const std::uint64_t payload_size = ReadStoredVarint();
+    if (start != kRansTotal || payload_size < 4 ||
+        payload_size > static_cast<std::uint64_t>(m_end - m_position)) {
+      m_corrupt = true;
+      return;
+    }
+    m_end = m_position + payload_size;
+    for (unsigned shift = 0; shift < 32; shift += 8)
+      m_state |= std::uint32_t{ReadStoredByte()} << shift;
+    if (m_state < kRansLowerBound || m_state >= kRansLowerBound << 8)
+      m_corrupt = true;
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief The next value of the channel
+  /////////////////////////////////////////////////
+  std::uint32_t Next() {
+    std::uint32_t zigzag = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+      const std::uint8_t byte = ReadByte();
+      zigzag |= static_cast<std::uint32_t>(byte & 0x7fu) << shift;
+      if ((byte & 0x80u) == 0)
+        break;
+    }
+    m_value += (zigzag >> 1) ^ (0u - (zigzag & 1u));
+    return m_value;
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Where the channel's data ends and the next channel's begins
+  /////////////////////////////////////////////////
+  const std::uint8_t *GetEnd() const { return m_end; }
+
+  /////////////////////////////////////////////////
+  /// @brief Throw std::runtime_error unless the channel was read to its end
+  /// without running out of data
+  /////////////////////////////////////////////////
+  void Finish() const {
+    // a rANS payload read to its end leaves the state the encoder started
+    // from
+    if (m_corrupt || m_num_bytes_read != m_num_bytes ||
+        m_position != m_end ||
+        (m_coding == ChannelCoding::Rans && m_state != kRansLowerBound))
+      throw std::runtime_error("Compressed snapshot is corrupt.");
+  }
+};
+
+/////////////////////////////////////////////////
+/// @class CompressedVertexFileReader
+/// @brief Read-only mapping of a compressed vertex file that decodes one
+/// snapshot at a time, in any order, so memory stays at one snapshot. The
+/// header, table and palette are checked once when the file is opened.
+/////////////////////////////////////////////////
+class CompressedVertexFileReader {
+private:
+  VertexFileMapping m_mapping;
+
+  std::span<const CompressedVertexFileEntry> m_entries;
+
+  std::span<const VertexFileColor> m_palette;
+
+  void Validate(const std::filesystem::path &file_path) {
+    auto fail = [&](const char *reason) {
+      throw std::runtime_error(std::string(reason) + ": " +
+                               file_path.string());
+    };
+    if (m_mapping.GetSize() < sizeof(CompressedVertexFileHeader))
+      fail("Compressed vertex file is too short");
+
+    const CompressedVertexFileHeader &header =
+        m_mapping.GetArray<CompressedVertexFileHeader>(0, 1)[0];
+    if (header.m_magic != kCompressedVertexFileMagic)
+      fail("Not a compressed vertex file or not closed by its writer");
+    if (header.m_version != kCompressedVertexFileVersion)
+      fail("Unsupported compressed vertex file version");
+    if (header.m_byte_order != kVertexFileByteOrder)
+      fail("Compressed vertex file was written with another byte order");
+    if (header.m_file_size != m_mapping.GetSize())
+      fail("Compressed vertex file is truncated");
+    if (header.m_table_offset % kVertexFileAlignment != 0 ||
+        header.m_palette_offset % kVertexFileAlignment != 0 ||
+        !m_mapping.IsInFile(header.m_table_offset, header.m_num_snapshots,
+                            sizeof(CompressedVertexFileEntry)) ||
+        !m_mapping.IsInFile(header.m_palette_offset, header.m_num_colors,
+                            sizeof(VertexFileColor)))
+      fail("Compressed vertex file table runs past end of file");
+
+    m_entries = m_mapping.GetArray<CompressedVertexFileEntry>(
+        header.m_table_offset, header.m_num_snapshots);
+    m_palette = m_mapping.GetArray<VertexFileColor>(header.m_palette_offset,
+                                                    header.m_num_colors);
+    for (const CompressedVertexFileEntry &entry : m_entries) {
+      if (!m_mapping.IsInFile(entry.m_offset, entry.m_size, 1))
+        fail("Compressed vertex file snapshot runs past end of file");
+      // checked here so a corrupt count throws instead of being allocated
+      if (entry.m_num_vertices > entry.m_size * kMaxVerticesPerStoredByte)
+        fail("Compressed vertex file snapshot has too many vertices");
+    }
+  }
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Map a compressed vertex file, throws std::runtime_error if it
+  /// cannot be mapped or is not a complete file of this version
+  /////////////////////////////////////////////////
+  explicit CompressedVertexFileReader(const std::filesystem::path &file_path)
+      : m_mapping(file_path) {
+    Validate(file_path);
+  }
+
+  std::size_t GetSnapshotCount() const { return m_entries.size(); }
+
+  const CompressedVertexFileEntry &GetEntry(std::size_t snapshot) const {
+    return m_entries[snapshot];
+  }
+
+  std::span<const VertexFileColor> GetPalette() const { return m_palette; }
+
+  /////////////////////////////////////////////////
+  /// @brief Decode one snapshot into out, throws std::runtime_error if its
+  /// data is corrupt
+  /////////////////////////////////////////////////
+  void Decode(std::size_t snapshot, DecodedSnapshot &out) const {
+    const CompressedVertexFileEntry &entry = m_entries[snapshot];
+    const std::span<const std::uint8_t> data =
+        m_mapping.GetArray<std::uint8_t>(entry.m_offset, entry.m_size);
+    const std::uint8_t *end = data.data() + data.size();
+    out.m_index = entry.m_index;
+    if (entry.m_has_depth != 0)
+      DecodeVertices<true>(entry, data.data(), end, out);
+    else
+      DecodeVertices<false>(entry, data.data(), end, out);
+  }
+
+private:
+  /////////////////////////////////////////////////
+  /// @brief Decode the channels of every vertex together, so the rANS
+  /// states, each of which waits on its last step, advance side by side
+  /////////////////////////////////////////////////
+  template <bool kHasDepth>
+  void DecodeVertices(const CompressedVertexFileEntry &entry,
+                      const std::uint8_t *data, const std::uint8_t *end,
+                      DecodedSnapshot &out) const {
+    ChannelDecoder x_channel({data, end});
+    ChannelDecoder y_channel({x_channel.GetEnd(), end});
+    ChannelDecoder color_channel({y_channel.GetEnd(), end});
+    // left empty, and never read, when the snapshot has no depth
+    ChannelDecoder depth_channel(
+        {color_channel.GetEnd(), kHasDepth ? end : color_channel.GetEnd()});
+
+    const size_t count = static_cast<size_t>(entry.m_num_vertices);
+    out.m_x.resize(count);
+    out.m_y.resize(count);
+    out.m_colors.resize(count);
+    out.m_depth.resize(kHasDepth ? count : 0);
+    float *xs = out.m_x.data();
+    float *ys = out.m_y.data();
+    VertexFileColor *colors = out.m_colors.data();
+    float *depths = out.m_depth.data();
+
+    const double x_step = GetQuantizationStep(entry.m_min_x, entry.m_max_x);
+    const double y_step = GetQuantizationStep(entry.m_min_y, entry.m_max_y);
+    const double depth_step =
+        GetQuantizationStep(entry.m_min_depth, entry.m_max_depth);
+    const VertexFileColor *palette = m_palette.data();
+    const std::uint32_t num_colors =
+        static_cast<std::uint32_t>(m_palette.size());
+    if (count > 0 && num_colors == 0)
+      throw std::runtime_error("Compressed snapshot is corrupt.");
+    bool bad_color = false;
+    for (size_t i = 0; i < count; ++i) {
+      const std::uint32_t x = x_channel.Next();
+      const std::uint32_t y = y_channel.Next();
+      const std::uint32_t color = color_channel.Next();
+      xs[i] = Dequantize(entry.m_min_x, x_step, x);
+      ys[i] = Dequantize(entry.m_min_y, y_step, y);
+      bad_color |= color >= num_colors;
+      colors[i] = palette[color < num_colors ? color : 0];
+      if constexpr (kHasDepth) {
+        depths[i] = Dequantize(entry.m_min_depth, depth_step,
+                               depth_channel.Next());
+      }
+    }
+
+    x_channel.Finish();
+    y_channel.Finish();
+    color_channel.Finish();
+    if constexpr (kHasDepth)
+      depth_channel.Finish();
+    if (bad_color)
+      throw std::runtime_error("Compressed snapshot is corrupt.");
+  }
+};
+} // namespace projection_generator
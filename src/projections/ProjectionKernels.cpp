@@ -0,0 +1,247 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the vertex transform and facing test kernels
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ProjectionKernels.h"
+#include <iostream>
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#define PROJECTION_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define PROJECTION_KERNELS_X86 0
+#endif
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief The single definition of both products, shared by the scalar
+/// loops and the vector tails. This file is built without floating point
+/// contraction, see CMakeLists.txt.
+/////////////////////////////////////////////////
+float Transform(const std::array<float, 4> &row, float x, float y, float z) {
+  return row[0] * x + row[1] * y + row[2] * z + row[3];
+}
+
+/////////////////////////////////////////////////
+float Facing(const glm::vec3 &view, float x, float y, float z) {
+  return view.x * x + view.y * y + view.z * z;
+}
+
+/////////////////////////////////////////////////
+void TransformScalar(const ScreenTransform &transform, size_t first,
+                     size_t last, const float *xs, const float *ys,
+                     const float *zs, float *screen_x, float *screen_y) {
+  for (size_t i = first; i < last; ++i) {
+    screen_x[i] = Transform(transform.m_x_row, xs[i], ys[i], zs[i]);
+    screen_y[i] = Transform(transform.m_y_row, xs[i], ys[i], zs[i]);
+  }
+}
+
+/////////////////////////////////////////////////
+void TransformRowScalar(const std::array<float, 4> &row, size_t first,
+                        size_t last, const float *xs, const float *ys,
+                        const float *zs, float *out) {
+  for (size_t i = first; i < last; ++i)
+    out[i] = Transform(row, xs[i], ys[i], zs[i]);
+}
+
+#if PROJECTION_KERNELS_X86
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2"))) __m256
+TransformAvx2(const std::array<float, 4> &row, __m256 x, __m256 y,
+              __m256 z) {
+  const __m256 sum_xy =
+      _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(row[0]), x),
+                    _mm256_mul_ps(_mm256_set1_ps(row[1]), y));
+  const __m256 sum_xyz =
+      _mm256_add_ps(sum_xy, _mm256_mul_ps(_mm256_set1_ps(row[2]), z));
+  return _mm256_add_ps(sum_xyz, _mm256_set1_ps(row[3]));
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2"))) void
+TransformToScreenAvx2(const ScreenTransform &transform, size_t size,
+                      const float *xs, const float *ys, const float *zs,
+                      float *screen_x, float *screen_y) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 x = _mm256_loadu_ps(xs + i);
+    const __m256 y = _mm256_loadu_ps(ys + i);
+    const __m256 z = _mm256_loadu_ps(zs + i);
+    _mm256_storeu_ps(screen_x + i, TransformAvx2(transform.m_x_row, x, y, z));
+    _mm256_storeu_ps(screen_y + i, TransformAvx2(transform.m_y_row, x, y, z));
+  }
+  TransformScalar(transform, i, size, xs, ys, zs, screen_x, screen_y);
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2"))) void
+TransformRowAvx2(const std::array<float, 4> &row, size_t size,
+                 const float *xs, const float *ys, const float *zs,
+                 float *out) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    _mm256_storeu_ps(out + i, TransformAvx2(row, _mm256_loadu_ps(xs + i),
+                                            _mm256_loadu_ps(ys + i),
+                                            _mm256_loadu_ps(zs + i)));
+  }
+  TransformRowScalar(row, i, size, xs, ys, zs, out);
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("sse4.1"))) __m128
+TransformSse41(const std::array<float, 4> &row, __m128 x, __m128 y,
+               __m128 z) {
+  const __m128 sum_xy = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), x),
+                                   _mm_mul_ps(_mm_set1_ps(row[1]), y));
+  const __m128 sum_xyz =
+      _mm_add_ps(sum_xy, _mm_mul_ps(_mm_set1_ps(row[2]), z));
+  return _mm_add_ps(sum_xyz, _mm_set1_ps(row[3]));
+}
+
+/////////////////////////////////////////////////
+/// @brief Eight vertices per iteration as two halves, matching the AVX2
+/// kernel's tail
+/////////////////////////////////////////////////
+__attribute__((target("sse4.1"))) void
+TransformToScreenSse41(const ScreenTransform &transform, size_t size,
+                       const float *xs, const float *ys, const float *zs,
+                       float *screen_x, float *screen_y) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    for (size_t half = i; half < i + 8; half += 4) {
+      const __m128 x = _mm_loadu_ps(xs + half);
+      const __m128 y = _mm_loadu_ps(ys + half);
+      const __m128 z = _mm_loadu_ps(zs + half);
+      _mm_storeu_ps(screen_x + half,
+                    TransformSse41(transform.m_x_row, x, y, z));
+      _mm_storeu_ps(screen_y + half,
+                    TransformSse41(transform.m_y_row, x, y, z));
+    }
+  }
+  TransformScalar(transform, i, size, xs, ys, zs, screen_x, screen_y);
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("sse4.1"))) void
+TransformRowSse41(const std::array<float, 4> &row, size_t size,
+                  const float *xs, const float *ys, const float *zs,
+                  float *out) {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    _mm_storeu_ps(out + i,
+                  TransformSse41(row, _mm_loadu_ps(xs + i),
+                                 _mm_loadu_ps(ys + i), _mm_loadu_ps(zs + i)));
+  }
+  TransformRowScalar(row, i, size, xs, ys, zs, out);
+}
+
+#endif
+
+/////////////////////////////////////////////////
+SimdLevel DetectSimdLevel() {
+  SimdLevel level = SimdLevel::Scalar;
+#if PROJECTION_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    level = SimdLevel::Avx2;
+  else if (__builtin_cpu_supports("sse4.1"))
+    level = SimdLevel::Sse41;
+#endif
+  std::cout << "[DEBUG] Projection kernels use " << GetSimdLevelName(level)
+            << "." << std::endl;
+  return level;
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+SimdLevel GetSupportedSimdLevel() {
+  static const SimdLevel level = DetectSimdLevel();
+  return level;
+}
+
+/////////////////////////////////////////////////
+const char *GetSimdLevelName(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::Avx2:
+    return "AVX2";
+  case SimdLevel::Sse41:
+    return "SSE4.1";
+  case SimdLevel::Scalar:
+    break;
+  }
+  return "scalar";
+}
+
+/////////////////////////////////////////////////
+void TransformToScreen(const ScreenTransform &transform,
+                       std::span<const float> xs, std::span<const float> ys,
+                       std::span<const float> zs, std::span<float> screen_x,
+                       std::span<float> screen_y, SimdLevel level) {
+  const size_t size = xs.size();
+  switch (level) {
+#if PROJECTION_KERNELS_X86
+  case SimdLevel::Avx2:
+    TransformToScreenAvx2(transform, size, xs.data(), ys.data(), zs.data(),
+                          screen_x.data(), screen_y.data());
+    return;
+  case SimdLevel::Sse41:
+    TransformToScreenSse41(transform, size, xs.data(), ys.data(), zs.data(),
+                           screen_x.data(), screen_y.data());
+    return;
+#endif
+  default:
+    TransformScalar(transform, 0, size, xs.data(), ys.data(), zs.data(),
+                    screen_x.data(), screen_y.data());
+    return;
+  }
+}
+
+/////////////////////////////////////////////////
+void TransformRow(const std::array<float, 4> &row, std::span<const float> xs,
+                  std::span<const float> ys, std::span<const float> zs,
+                  std::span<float> out, SimdLevel level) {
+  const size_t size = xs.size();
+  switch (level) {
+#if PROJECTION_KERNELS_X86
+  case SimdLevel::Avx2:
+    TransformRowAvx2(row, size, xs.data(), ys.data(), zs.data(), out.data());
+    return;
+  case SimdLevel::Sse41:
+    TransformRowSse41(row, size, xs.data(), ys.data(), zs.data(), out.data());
+    return;
+#endif
+  default:
+    TransformRowScalar(row, 0, size, xs.data(), ys.data(), zs.data(),
+                       out.data());
+    return;
+  }
+}
+
+/////////////////////////////////////////////////
+void AppendFacingTriangles(const glm::vec3 &view, float threshold,
+                           std::span<const float> nx,
+                           std::span<const float> ny,
+                           std::span<const float> nz,
+                           std::span<const std::uint32_t> candidates,
+                           std::vector<std::uint32_t> &out) {
+  for (const std::uint32_t t : candidates) {
+    if (Facing(view, nx[t], ny[t], nz[t]) > threshold)
+      out.push_back(t);
+  }
+}
+
+} // namespace projection_generator
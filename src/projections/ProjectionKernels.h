@@ -0,0 +1,89 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the vertex transform and facing test kernels
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief Instruction sets the kernels are compiled for. Every level does
+/// the same float operations in the same order, without fused multiply-add,
+/// so all of them give bit identical results.
+/////////////////////////////////////////////////
+enum class SimdLevel { Scalar, Sse41, Avx2 };
+
+/////////////////////////////////////////////////
+/// @brief Highest level the running CPU supports, detected once
+/////////////////////////////////////////////////
+SimdLevel GetSupportedSimdLevel();
+
+const char *GetSimdLevelName(SimdLevel level);
+
+/////////////////////////////////////////////////
+/// @brief The rows of an affine matrix that produce screen x and y:
+/// x' = r[0] * x + r[1] * y + r[2] * z + r[3], added left to right
+/////////////////////////////////////////////////
+struct ScreenTransform {
+  std::array<float, 4> m_x_row{};
+
+  std::array<float, 4> m_y_row{};
+};
+
+/////////////////////////////////////////////////
+/// @brief Transform structure of arrays positions to screen x and y, eight
+/// vertices per iteration on the vector levels
+///
+/// @param xs, ys, zs Positions, all the same size
+/// @param screen_x, screen_y Receive one value per vertex, at least as large
+/// as xs
+/// @param level Instruction set to use, must be supported by the CPU
+/////////////////////////////////////////////////
+void TransformToScreen(const ScreenTransform &transform,
+                       std::span<const float> xs, std::span<const float> ys,
+                       std::span<const float> zs, std::span<float> screen_x,
+                       std::span<float> screen_y,
+                       SimdLevel level = GetSupportedSimdLevel());
+
+/////////////////////////////////////////////////
+/// @brief As TransformToScreen for a single row, such as the one giving
+/// screen depth
+///
+/// @param out Receives one value per vertex, at least as large as xs
+/////////////////////////////////////////////////
+void TransformRow(const std::array<float, 4> &row, std::span<const float> xs,
+                  std::span<const float> ys, std::span<const float> zs,
+                  std::span<float> out,
+                  SimdLevel level = GetSupportedSimdLevel());
+
+/////////////////////////////////////////////////
+/// @brief Append every candidate triangle whose normal has a dot product
+/// with view above threshold, in candidate order. The dot product is
+/// (view.x nx + view.y ny) + view.z nz like glm::dot.
+///
+/// @param nx, ny, nz Triangle normals, see TriangleNormals
+/// @param candidates Triangles to test, such as the boundary triangles of
+/// VisibilityIndex
+/////////////////////////////////////////////////
+void AppendFacingTriangles(const glm::vec3 &view, float threshold,
+                           std::span<const float> nx,
+                           std::span<const float> ny,
+                           std::span<const float> nz,
+                           std::span<const std::uint32_t> candidates,
+                           std::vector<std::uint32_t> &out);
+
+} // namespace projection_generator
@@ -6,71 +6,300 @@
 /// Headers
 /////////////////////////////////////////////////
 #include "Projector.h"
+#include "ProjectionKernels.h"
+#include "RadixSort.h"
+#include "ThreadPool.h"
+#include "VisibilityIndex.h"
 #include "glm/ext/matrix_transform.hpp"
 #include "glm/ext/vector_float3.hpp"
 #include <SFML/Graphics/PrimitiveType.hpp>
 #include <SFML/Graphics/Vertex.hpp>
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <vector>
 namespace projection_generator {
 
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Screen x and y of every vertex, see ProjectionKernels.h
+/////////////////////////////////////////////////
+void TransformToScreen(const Fragment3D &fragment, const glm::mat4 &m,
+                       std::vector<float> &screen_x,
+                       std::vector<float> &screen_y) {
+  const std::span<const float> xs = fragment.GetPositionsX();
+  screen_x.resize(xs.size());
+  screen_y.resize(xs.size());
+
+  const ScreenTransform transform{{m[0][0], m[1][0], m[2][0], m[3][0]},
+                                  {m[0][1], m[1][1], m[2][1], m[3][1]}};
+  TransformToScreen(transform, xs, fragment.GetPositionsY(),
+                    fragment.GetPositionsZ(), screen_x, screen_y);
+}
+
+/////////////////////////////////////////////////
+/// @brief Unit vector whose dot product with an object space normal has the
+/// sign of the projected triangle's winding, or zero if the projection is
+/// degenerate.
+///
+/// The screen space winding is the z of the cross product of the projected
+/// edges, which for an affine projection equals dot(view, n) with n the
+/// object space normal and view the z row of the cofactor matrix of the
+/// linear part.
+/////////////////////////////////////////////////
+glm::vec3 GetViewDirection(const glm::mat4 &m) {
+  const glm::vec3 c0(m[0]);
+  const glm::vec3 c1(m[1]);
+  const glm::vec3 c2(m[2]);
+  const glm::vec3 view(glm::cross(c1, c2).z, glm::cross(c2, c0).z,
+                       glm::cross(c0, c1).z);
+  const float length = glm::length(view);
+  return length > 0.0f ? view / length : glm::vec3(0.0f);
+}
+
+/////////////////////////////////////////////////
+/// @brief Write a triangle's corners to slots 3 slot to 3 slot + 2 of an
+/// output sized up front, which saves append's growth checks
+/////////////////////////////////////////////////
+template <typename Triangle>
+void WriteTriangle(std::span<sf::Vertex> result, size_t slot,
+                   const Triangle &tri, const std::vector<float> &screen_x,
+                   const std::vector<float> &screen_y,
+                   std::span<const sf::Color> colors) {
+  for (size_t corner = 0; corner < 3; ++corner) {
+    result[slot * 3 + corner] =
+        sf::Vertex(sf::Vector2f(screen_x[tri[corner]], screen_y[tri[corner]]),
+                   colors[tri[corner]]);
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Sort triangle indices from the smallest to the largest screen z.
+/// Front faces wind counter clockwise, so the viewer sits towards +z and
+/// this is back to front. The summed corner depths order like the centroid
+/// depths without the division or the translation. items and scratch are
+/// the caller's buffers, reused so a sweep sorts without allocating.
+/////////////////////////////////////////////////
+void SortBackToFront(const Fragment3D &fragment, const glm::mat4 &m,
+                     std::vector<std::uint32_t> &drawn,
+                     std::vector<std::uint64_t> &items,
+                     RadixSortScratch &scratch) {
+  const std::span<const float> xs = fragment.GetPositionsX();
+  const std::span<const float> ys = fragment.GetPositionsY();
+  const std::span<const float> zs = fragment.GetPositionsZ();
+
+  items.resize(drawn.size());
+  fragment.GetTriangles().Visit([&](auto triangles) {
+    for (size_t slot = 0; slot < drawn.size(); ++slot) {
+      const auto &tri = triangles[drawn[slot]];
+      const float x = xs[tri[0]] + xs[tri[1]] + xs[tri[2]];
+      const float y = ys[tri[0]] + ys[tri[1]] + ys[tri[2]];
+      const float z = zs[tri[0]] + zs[tri[1]] + zs[tri[2]];
+      items[slot] = MakeSortItem(
+          GetSortableKey(m[0][2] * x + m[1][2] * y + m[2][2] * z),
+          drawn[slot]);
+    }
+  });
+  RadixSortByKey(items, scratch);
+  for (size_t slot = 0; slot < drawn.size(); ++slot)
+    drawn[slot] = static_cast<std::uint32_t>(items[slot]);
+}
+
+/////////////////////////////////////////////////
+/// @brief Replace out with the boundary triangles of a sweep snapshot that
+/// pass the exact facing test
+/////////////////////////////////////////////////
+void GetBoundaryFacing(const Fragment3D &fragment, const glm::mat4 &m,
+                       std::span<const std::uint32_t> boundary,
+                       std::vector<std::uint32_t> &out) {
+  const TriangleNormals &normals = fragment.GetTriangleNormals();
+  out.clear();
+  AppendFacingTriangles(GetViewDirection(m), kMinFacing, normals.GetX(),
+                        normals.GetY(), normals.GetZ(), boundary, out);
+}
+
+/////////////////////////////////////////////////
+size_t CountSetBits(std::span<const std::uint64_t> bits) {
+  size_t count = 0;
+  for (const std::uint64_t word : bits)
+    count += static_cast<size_t>(std::popcount(word));
+  return count;
+}
+
+/////////////////////////////////////////////////
+/// @brief Mean position of the fragment's vertices
+/////////////////////////////////////////////////
+glm::vec3 GetCentre(const Fragment3D &fragment) {
+  const std::span<const float> xs = fragment.GetPositionsX();
+  const std::span<const float> ys = fragment.GetPositionsY();
+  const std::span<const float> zs = fragment.GetPositionsZ();
+  glm::vec3 centre(0.0f);
+  for (size_t i = 0; i < xs.size(); ++i) {
+    centre.x += xs[i];
+    centre.y += ys[i];
+    centre.z += zs[i];
+  }
+  return centre / static_cast<float>(xs.size());
+}
+
+/////////////////////////////////////////////////
+/// @brief Model matrix of step i of a sweep: move the fragment's centre to
+/// the origin, tilt it, turn it about the rotation axis and move it to the
+/// window center
+/////////////////////////////////////////////////
+glm::mat4 GetSweepModelMatrix(const glm::mat4 &translate_to_origin,
+                              const glm::mat4 &tilt,
+                              const glm::vec3 &rotation_axis,
+                              size_t rotation_intervals, size_t i) {
+  float angle = static_cast<float>(i) *
+                (360.0f / static_cast<float>(rotation_intervals));
+  glm::mat4 rotation =
+      glm::rotate(glm::mat4(1.0f), glm::radians(angle), rotation_axis);
+
+  // add a translation to move it back to the window center
+  glm::mat4 translate_to_window_center =
+      glm::translate(glm::mat4(1.0f), glm::vec3(400.0f, 300.0f, 0.0f));
+  return translate_to_window_center * rotation * tilt * translate_to_origin;
+}
+
+/////////////////////////////////////////////////
+/// @brief Sweep of RotateFragmentAboutY and SweepFragmentAboutY
+/////////////////////////////////////////////////
+const glm::vec3 kAboutYRotationAxis(0.0f, 1.0f, 0.0f); // Y-axis
+const glm::vec3 kAboutYTiltAxis(1.0f, 0.0f, 0.0f);     // X-axis
+constexpr float kAboutYTiltAngle = -30.0f;             // Tilt angle in degrees
+
+/////////////////////////////////////////////////
+/// @brief Runs of snapshots a parallel sweep is cut into per thread, the
+/// caller included. Each run replays the visibility index up to its first
+/// snapshot, so runs should be long enough to make that cheap, but there
+/// should be several per thread so threads that finish early take over the
+/// rest of an uneven sweep.
+/////////////////////////////////////////////////
+constexpr size_t kTasksPerThread = 4;
+
+} // namespace
+
+/////////////////////////////////////////////////
+Projector::Projector(ThreadPool &thread_pool) : m_thread_pool(thread_pool) {}
+
+/////////////////////////////////////////////////
+void Projector::SetParallelSweep(bool enabled) { m_parallel_sweep = enabled; }
+
+/////////////////////////////////////////////////
+void Projector::SetDepthSort(bool enabled) { m_depth_sort = enabled; }
+
+/////////////////////////////////////////////////
+void Projector::SetKeepDepth(bool enabled) { m_keep_depth = enabled; }
+
+/////////////////////////////////////////////////
+void Projector::SetSweepLogging(bool enabled) { m_sweep_logging = enabled; }
+
 /////////////////////////////////////////////////
 void Projector::RotateFragmentAboutY(const Fragment3D &fragment,
                                      const size_t rotation_intervals) {
 
-  // set variables specific to this function
-  glm::vec3 rotation_axis(0.0f, 1.0f, 0.0f); // Y-axis
-  glm::vec3 tilt_axis(1.0f, 0.0f, 0.0f);     // X-axis
-  float tilt_angle = -30.0f;                 // Tilt angle in degrees
-
   // Rotate and snapshot the fragment
-  RotateAndSnapshotFragment(fragment, tilt_angle, tilt_axis, rotation_intervals,
-                            rotation_axis);
+  RotateAndSnapshotFragment(fragment, kAboutYTiltAngle, kAboutYTiltAxis,
+                            rotation_intervals, kAboutYRotationAxis);
 }
+
 /////////////////////////////////////////////////
-sf::VertexArray Projector::ProjectToVertexArray(const Fragment3D &fragment,
-                                                const glm::mat4 &model_matrix) {
+SnapshotSweep
+Projector::SweepFragmentAboutY(const Fragment3D &fragment,
+                               const size_t rotation_intervals) const {
+  return SnapshotSweep(*this, fragment, kAboutYTiltAngle, kAboutYTiltAxis,
+                       rotation_intervals, kAboutYRotationAxis);
+}
 
-  std::vector<glm::vec3> transformed;
+/////////////////////////////////////////////////
+void Projector::ProjectSweepSnapshot(const Fragment3D &fragment,
+                                     const glm::mat4 &model_matrix,
+                                     std::span<const std::uint32_t> boundary,
+                                     std::vector<std::uint64_t> &facing,
+                                     Scratch &scratch,
+                                     std::span<sf::Vertex> vertices,
+                                     std::span<float> depth) const {
+  CollectSweepTriangles(fragment, model_matrix, boundary, facing, scratch);
+  EmitTriangles(fragment, model_matrix, scratch, vertices, depth);
+}
 
-  size_t num_culled_triangles = 0;
-  // Step 1: Transform all vertex positions
-  const auto &vertices = fragment.GetVertices();
-  for (const auto &v : vertices) {
-    glm::vec4 world = model_matrix * glm::vec4(v.m_position, 1.0f);
-    transformed.push_back(glm::vec3(world)); // No projection or normalization
-  }
+/////////////////////////////////////////////////
+void Projector::CollectSweepTriangles(const Fragment3D &fragment,
+                                      const glm::mat4 &model_matrix,
+                                      std::span<const std::uint32_t> boundary,
+                                      std::vector<std::uint64_t> &facing,
+                                      Scratch &scratch) const {
 
-  sf::VertexArray result(sf::PrimitiveType::Triangles);
-
-  // Step 2: For each triangle
-  for (const auto &tri : fragment.GetTriangles()) {
-    const glm::vec2 p0 = glm::vec2(transformed[tri[0]]);
-    const glm::vec2 p1 = glm::vec2(transformed[tri[1]]);
-    const glm::vec2 p2 = glm::vec2(transformed[tri[2]]);
-
-    // Step 3: Backface culling (screen-space)
-    glm::vec2 v0 = p1 - p0;
-    glm::vec2 v1 = p2 - p0;
-    float cross_z = v0.x * v1.y - v0.y * v1.x;
-    if (cross_z <= 0.0f) {
-      num_culled_triangles++;
-      continue; // Skip this triangle if it is back-facing
+  // triangles near the edge of their facing arc get the exact test and join
+  // the facing set for this snapshot only
+  std::vector<std::uint32_t> boundary_facing;
+  GetBoundaryFacing(fragment, model_matrix, boundary, boundary_facing);
+  for (const std::uint32_t t : boundary_facing)
+    facing[t / 64] |= std::uint64_t{1} << (t % 64);
+
+  std::vector<std::uint32_t> &drawn = scratch.m_drawn;
+  drawn.clear();
+  for (size_t word = 0; word < facing.size(); ++word) {
+    for (std::uint64_t bits = facing[word]; bits != 0; bits &= bits - 1) {
+      drawn.push_back(
+          static_cast<std::uint32_t>(word * 64 + std::countr_zero(bits)));
     }
+  }
 
-    // Step 4: Output raw float 2D triangles with color
+  for (const std::uint32_t t : boundary_facing)
+    facing[t / 64] &= ~(std::uint64_t{1} << (t % 64));
+}
 
-    result.append(
-        sf::Vertex(sf::Vector2f(p0.x, p0.y), vertices[tri[0]].m_color));
-    result.append(
-        sf::Vertex(sf::Vector2f(p1.x, p1.y), vertices[tri[1]].m_color));
-    result.append(
-        sf::Vertex(sf::Vector2f(p2.x, p2.y), vertices[tri[2]].m_color));
+/////////////////////////////////////////////////
+void Projector::EmitTriangles(const Fragment3D &fragment,
+                              const glm::mat4 &model_matrix, Scratch &scratch,
+                              std::span<sf::Vertex> vertices,
+                              std::span<float> depth) const {
+  std::vector<std::uint32_t> &drawn = scratch.m_drawn;
+  if (m_depth_sort)
+    SortBackToFront(fragment, model_matrix, drawn, scratch.m_sort_items,
+                    scratch.m_sort);
+
+  TransformToScreen(fragment, model_matrix, scratch.m_screen_x,
+                    scratch.m_screen_y);
+  const std::span<const sf::Color> colors = fragment.GetColors();
+
+  // the loop is compiled for the index width the fragment stores
+  fragment.GetTriangles().Visit([&](auto triangles) {
+    for (size_t slot = 0; slot < drawn.size(); ++slot) {
+      WriteTriangle(vertices, slot, triangles[drawn[slot]], scratch.m_screen_x,
+                    scratch.m_screen_y, colors);
+    }
+  });
+
+  if (!depth.empty()) {
+    const std::span<const float> xs = fragment.GetPositionsX();
+    std::vector<float> &screen_z = scratch.m_screen_z;
+    screen_z.resize(xs.size());
+    TransformRow({model_matrix[0][2], model_matrix[1][2], model_matrix[2][2],
+                  model_matrix[3][2]},
+                 xs, fragment.GetPositionsY(), fragment.GetPositionsZ(),
+                 screen_z);
+    fragment.GetTriangles().Visit([&](auto triangles) {
+      for (size_t slot = 0; slot < drawn.size(); ++slot) {
+        const auto &tri = triangles[drawn[slot]];
+        for (size_t corner = 0; corner < 3; ++corner)
+          depth[slot * 3 + corner] = screen_z[tri[corner]];
+      }
+    });
   }
-  std::cout << "[DEBUG] Projector::ProjectToVertexArray: "
-            << "Culled " << num_culled_triangles << " triangles out of "
-            << fragment.GetTriangles().size() << " total triangles."
-            << std::endl;
-  return result;
 }
+/////////////////////////////////////////////////
+void Projector::StreamFragmentAboutY(const Fragment3D &fragment,
+                                     const size_t rotation_intervals,
+                                     SnapshotSink &sink) const {
+  for (const Snapshot &snapshot :
+       SweepFragmentAboutY(fragment, rotation_intervals))
+    sink.Write(snapshot);
+}
+
 /////////////////////////////////////////////////
 void Projector::RotateAndSnapshotFragment(const Fragment3D &fragment,
                                           const float tilt_angle,
@@ -78,38 +307,213 @@ void Projector::RotateAndSnapshotFragment(const Fragment3D &fragment,
                                           const size_t rotation_intervals,
                                           const glm::vec3 rotation_axis) {
   // Compute center of fragment
-  glm::vec3 centre(0.0f);
-  for (const auto &vertex : fragment.GetVertices()) {
-    centre += vertex.m_position;
-  }
-  centre /= static_cast<float>(fragment.GetVertices().size());
-
-  glm::mat4 translate_to_origin = glm::translate(glm::mat4(1.0f), -centre);
+  glm::mat4 translate_to_origin =
+      glm::translate(glm::mat4(1.0f), -GetCentre(fragment));
   glm::mat4 tilt =
       glm::rotate(glm::mat4(1.0f), glm::radians(tilt_angle), tilt_axis);
 
-  // add a translation to move it back to the window center
-  glm::mat4 translate_to_window_center =
-      glm::translate(glm::mat4(1.0f), glm::vec3(400.0f, 300.0f, 0.0f));
-  // Rotate around the object's center at various angles
+  // facing sets for every angle, updated incrementally as the sweep goes
+  const VisibilityIndex visibility(m_thread_pool, fragment, glm::mat3(tilt),
+                                   rotation_axis, rotation_intervals);
+
+  const size_t num_tasks =
+      m_parallel_sweep ? (m_thread_pool.GetThreadCount() + 1) * kTasksPerThread
+                       : 1;
+  const size_t grain = (rotation_intervals + num_tasks - 1) / num_tasks;
+
+  // Rotate around the object's center at various angles, calling
+  // visit(i, model_matrix, facing, scratch) for every angle i
+  auto sweep = [&](auto visit) {
+    m_thread_pool.ParallelFor(
+        0, rotation_intervals, grain, [&](size_t first, size_t last) {
+          Scratch scratch;
+          std::vector<std::uint64_t> facing;
+          visibility.Seek(first, facing);
+          for (size_t i = first; i < last; ++i) {
+            if (i > first)
+              visibility.Advance(i, facing);
+            visit(i,
+                  GetSweepModelMatrix(translate_to_origin, tilt,
+                                      rotation_axis, rotation_intervals, i),
+                  facing, scratch);
+          }
+        });
+  };
+
+  // a first pass only counts the triangles every angle draws, so the pools
+  // grow once and every angle owns a slice of them, which keeps the shapes
+  // in angle order however the runs of angles are spread over the threads
+  std::vector<size_t> num_drawn(rotation_intervals);
+  sweep([&](size_t i, const glm::mat4 &model_matrix,
+            std::vector<std::uint64_t> &facing, Scratch &scratch) {
+    GetBoundaryFacing(fragment, model_matrix,
+                      visibility.GetBoundaryTriangles(i), scratch.m_drawn);
+    num_drawn[i] = CountSetBits(facing) + scratch.m_drawn.size();
+  });
+
+  const size_t first_shape = GetShapeCount();
   for (size_t i = 0; i < rotation_intervals; ++i) {
-    float angle = static_cast<float>(i) *
-                  (360.0f / static_cast<float>(rotation_intervals));
-    glm::mat4 rotation =
-        glm::rotate(glm::mat4(1.0f), glm::radians(angle), rotation_axis);
+    m_shape_offsets.push_back(m_shape_offsets.back() + num_drawn[i] * 3);
+    m_depth_offsets.push_back(m_depth_offsets.back() +
+                              (m_keep_depth ? num_drawn[i] * 3 : 0));
+  }
+  m_vertex_pool.resize(m_shape_offsets.back());
+  m_depth_pool.resize(m_depth_offsets.back());
 
-    glm::mat4 model_matrix =
-        translate_to_window_center * rotation * tilt * translate_to_origin;
+  sweep([&](size_t i, const glm::mat4 &model_matrix,
+            std::vector<std::uint64_t> &facing, Scratch &scratch) {
+    const size_t shape = first_shape + i;
+    ProjectSweepSnapshot(
+        fragment, model_matrix, visibility.GetBoundaryTriangles(i), facing,
+        scratch,
+        std::span(m_vertex_pool)
+            .subspan(m_shape_offsets[shape], num_drawn[i] * 3),
+        std::span(m_depth_pool)
+            .subspan(m_depth_offsets[shape],
+                     m_depth_offsets[shape + 1] - m_depth_offsets[shape]));
+  });
+
+  // reported afterwards so the lines stay in angle order
+  if (!m_sweep_logging)
+    return;
+  const size_t num_triangles = fragment.GetTriangles().size();
+  for (size_t i = 0; i < rotation_intervals; ++i) {
+    std::cout << "[DEBUG] Projector::ProjectSweepSnapshot: "
+              << "Culled " << num_triangles - num_drawn[i]
+              << " triangles out of " << num_triangles
+              << " total triangles with "
+              << visibility.GetBoundaryTriangles(i).size()
+              << " boundary tests." << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+size_t Projector::GetShapeCount() const { return m_shape_offsets.size() - 1; }
+
+/////////////////////////////////////////////////
+std::span<const sf::Vertex> Projector::GetShape(size_t index) const {
+  return std::span(m_vertex_pool)
+      .subspan(m_shape_offsets[index],
+               m_shape_offsets[index + 1] - m_shape_offsets[index]);
+}
+
+/////////////////////////////////////////////////
+std::span<const float> Projector::GetShapeDepth(size_t index) const {
+  return std::span(m_depth_pool)
+      .subspan(m_depth_offsets[index],
+               m_depth_offsets[index + 1] - m_depth_offsets[index]);
+}
+
+/////////////////////////////////////////////////
+sf::FloatRect Projector::GetShapeBounds(size_t index) const {
+  return GetVertexBounds(GetShape(index));
+}
+
+/////////////////////////////////////////////////
+sf::FloatRect GetVertexBounds(std::span<const sf::Vertex> vertices) {
+  if (vertices.empty())
+    return {};
 
-    sf::VertexArray projected_shape =
-        ProjectToVertexArray(fragment, model_matrix);
-    m_projected_shapes.push_back(projected_shape);
+  sf::Vector2f min = vertices.front().position;
+  sf::Vector2f max = min;
+  for (const sf::Vertex &vertex : vertices) {
+    min.x = std::min(min.x, vertex.position.x);
+    min.y = std::min(min.y, vertex.position.y);
+    max.x = std::max(max.x, vertex.position.x);
+    max.y = std::max(max.y, vertex.position.y);
   }
+  return {min, max - min};
 }
 
 /////////////////////////////////////////////////
-const std::vector<sf::VertexArray> &Projector::GetProjectedShapes() const {
-  return m_projected_shapes;
+std::span<const sf::Vertex> Projector::GetVertexPool() const {
+  return m_vertex_pool;
+}
+
+/////////////////////////////////////////////////
+std::span<const size_t> Projector::GetShapeOffsets() const {
+  return m_shape_offsets;
+}
+
+/////////////////////////////////////////////////
+SnapshotSweep::SnapshotSweep(const Projector &projector,
+                             const Fragment3D &fragment,
+                             const float tilt_angle, const glm::vec3 tilt_axis,
+                             const size_t rotation_intervals,
+                             const glm::vec3 rotation_axis)
+    : m_projector(projector), m_fragment(fragment),
+      m_tilt(glm::rotate(glm::mat4(1.0f), glm::radians(tilt_angle),
+                         tilt_axis)),
+      m_translate_to_origin(
+          glm::translate(glm::mat4(1.0f), -GetCentre(fragment))),
+      m_rotation_axis(rotation_axis), m_rotation_intervals(rotation_intervals),
+      m_visibility(projector.m_thread_pool, fragment, glm::mat3(m_tilt),
+                   rotation_axis, rotation_intervals) {}
+
+/////////////////////////////////////////////////
+void SnapshotSweep::Project(size_t index) {
+  m_current = Snapshot{index, {}, {}};
+  if (index >= m_rotation_intervals)
+    return;
+
+  // steps come in order, and Advance starts over at step 0
+  m_visibility.Advance(index, m_facing);
+  const glm::mat4 model_matrix =
+      GetSweepModelMatrix(m_translate_to_origin, m_tilt, m_rotation_axis,
+                          m_rotation_intervals, index);
+  const std::span<const std::uint32_t> boundary =
+      m_visibility.GetBoundaryTriangles(index);
+  m_projector.CollectSweepTriangles(m_fragment, model_matrix, boundary,
+                                    m_facing, m_scratch);
+
+  const size_t num_drawn_triangles = m_scratch.m_drawn.size();
+  m_vertices.resize(num_drawn_triangles * 3);
+  m_depth.resize(m_projector.m_keep_depth ? num_drawn_triangles * 3 : 0);
+  m_projector.EmitTriangles(m_fragment, model_matrix, m_scratch, m_vertices,
+                            m_depth);
+  m_current.m_vertices = m_vertices;
+  m_current.m_depth = m_depth;
+}
+
+/////////////////////////////////////////////////
+SnapshotSweep::Iterator SnapshotSweep::begin() {
+  Project(0);
+  return Iterator(*this);
+}
+
+/////////////////////////////////////////////////
+std::default_sentinel_t SnapshotSweep::end() const {
+  return std::default_sentinel;
+}
+
+/////////////////////////////////////////////////
+size_t SnapshotSweep::size() const { return m_rotation_intervals; }
+
+/////////////////////////////////////////////////
+SnapshotSweep::Iterator::Iterator(SnapshotSweep &sweep) : m_sweep(&sweep) {}
+
+/////////////////////////////////////////////////
+const Snapshot &SnapshotSweep::Iterator::operator*() const {
+  return m_sweep->m_current;
+}
+
+/////////////////////////////////////////////////
+const Snapshot *SnapshotSweep::Iterator::operator->() const {
+  return &m_sweep->m_current;
+}
+
+/////////////////////////////////////////////////
+SnapshotSweep::Iterator &SnapshotSweep::Iterator::operator++() {
+  m_sweep->Project(m_sweep->m_current.m_index + 1);
+  return *this;
+}
+
+/////////////////////////////////////////////////
+void SnapshotSweep::Iterator::operator++(int) { ++*this; }
+
+/////////////////////////////////////////////////
+bool SnapshotSweep::Iterator::operator==(std::default_sentinel_t) const {
+  return m_sweep->m_current.m_index >= m_sweep->m_rotation_intervals;
 }
 
 } // namespace projection_generator
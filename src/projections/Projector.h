@@ -12,16 +12,93 @@
 /// Headers
 /////////////////////////////////////////////////
 #include "Fragment3D.h"
+#include "RadixSort.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+#include "VisibilityIndex.h"
 #include "glm/ext/matrix_float4x4.hpp"
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Vertex.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
+#include <cstdint>
 #include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <iterator>
+#include <span>
 #include <vector>
 namespace projection_generator {
 
+class SnapshotSweep;
+
 class Projector {
 
 private:
-  std::vector<sf::VertexArray> m_projected_shapes;
+  friend class SnapshotSweep;
+
+  /////////////////////////////////////////////////
+  /// @brief Pool the snapshots of a sweep are spread over
+  /////////////////////////////////////////////////
+  ThreadPool &m_thread_pool;
+
+  /////////////////////////////////////////////////
+  /// @brief Whether sweeps project several snapshots at once, see
+  /// SetParallelSweep
+  /////////////////////////////////////////////////
+  bool m_parallel_sweep{true};
+
+  /////////////////////////////////////////////////
+  /// @brief Whether shapes list their triangles back to front, see
+  /// SetDepthSort
+  /////////////////////////////////////////////////
+  bool m_depth_sort{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Whether m_depth_pool is filled, see SetKeepDepth
+  /////////////////////////////////////////////////
+  bool m_keep_depth{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Whether sweeps print their culling statistics, see
+  /// SetSweepLogging
+  /////////////////////////////////////////////////
+  bool m_sweep_logging{true};
+
+  /////////////////////////////////////////////////
+  /// @brief Vertices of every shape back to back, three per triangle.
+  /// Shape i is m_vertex_pool[m_shape_offsets[i], m_shape_offsets[i + 1]).
+  /////////////////////////////////////////////////
+  std::vector<sf::Vertex> m_vertex_pool;
+
+  std::vector<size_t> m_shape_offsets{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Screen depth of every vertex, laid out like m_vertex_pool.
+  /// Shapes projected while depth was not kept have an empty range.
+  /////////////////////////////////////////////////
+  std::vector<float> m_depth_pool;
+
+  std::vector<size_t> m_depth_offsets{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Buffers one thread reuses from snapshot to snapshot
+  /////////////////////////////////////////////////
+  struct Scratch {
+    std::vector<std::uint32_t> m_drawn;
+
+    std::vector<float> m_screen_x;
+
+    std::vector<float> m_screen_y;
+
+    std::vector<float> m_screen_z;
+
+    /////////////////////////////////////////////////
+    /// @brief Depth keys of the drawn triangles and the sort's buffers,
+    /// see SetDepthSort
+    /////////////////////////////////////////////////
+    std::vector<std::uint64_t> m_sort_items;
+
+    RadixSortScratch m_sort;
+  };
 
   void RotateAndSnapshotFragment(const Fragment3D &fragment,
                                  const float tilt_angle,
@@ -29,15 +106,234 @@ private:
                                  const size_t rotation_intervals,
                                  const glm::vec3 rotation_axis);
 
-  sf::VertexArray ProjectToVertexArray(const Fragment3D &fragment,
-                                       const glm::mat4 &model_matrix);
+  /////////////////////////////////////////////////
+  /// @brief Transform the fragment and write the triangles listed in
+  /// scratch.m_drawn, in depth order if that is enabled and in the given
+  /// order otherwise
+  ///
+  /// @param scratch Triangles to draw, reordered by the call, and buffers
+  /// @param vertices Receives three vertices per triangle
+  /// @param depth Receives the screen depth of every vertex unless empty
+  /////////////////////////////////////////////////
+  void EmitTriangles(const Fragment3D &fragment, const glm::mat4 &model_matrix,
+                     Scratch &scratch, std::span<sf::Vertex> vertices,
+                     std::span<float> depth) const;
+
+  /////////////////////////////////////////////////
+  /// @brief List in scratch.m_drawn the triangles drawn at one step of a
+  /// rotation sweep: those set in facing plus the boundary triangles that
+  /// pass the exact facing test
+  ///
+  /// @param boundary See VisibilityIndex::GetBoundaryTriangles
+  /// @param facing See VisibilityIndex::Advance, left as it was found
+  /////////////////////////////////////////////////
+  void CollectSweepTriangles(const Fragment3D &fragment,
+                             const glm::mat4 &model_matrix,
+                             std::span<const std::uint32_t> boundary,
+                             std::vector<std::uint64_t> &facing,
+                             Scratch &scratch) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Project one step of a rotation sweep, see CollectSweepTriangles
+  /// and EmitTriangles. Only reads settings, so snapshots can be projected
+  /// concurrently.
+  ///
+  /// @param vertices, depth See EmitTriangles, sized by a counting pass
+  /////////////////////////////////////////////////
+  void ProjectSweepSnapshot(const Fragment3D &fragment,
+                            const glm::mat4 &model_matrix,
+                            std::span<const std::uint32_t> boundary,
+                            std::vector<std::uint64_t> &facing,
+                            Scratch &scratch, std::span<sf::Vertex> vertices,
+                            std::span<float> depth) const;
 
 public:
-  Projector() = default;
+  /////////////////////////////////////////////////
+  /// @brief Constructor
+  ///
+  /// @param thread_pool Pool used to project the snapshots of a sweep in
+  /// parallel
+  /////////////////////////////////////////////////
+  explicit Projector(ThreadPool &thread_pool = ThreadPool::GetShared());
+
+  /////////////////////////////////////////////////
+  /// @brief Project the angles of a sweep in parallel (the default) or one
+  /// after another on the calling thread. Both give the same shapes in the
+  /// same order.
+  /////////////////////////////////////////////////
+  void SetParallelSweep(bool enabled);
+
+  /////////////////////////////////////////////////
+  /// @brief List the triangles of every shape from the farthest to the
+  /// nearest (painter's order) instead of in mesh order, so overlapping
+  /// faces of concave fragments draw correctly. Off by default.
+  /////////////////////////////////////////////////
+  void SetDepthSort(bool enabled);
+
+  /////////////////////////////////////////////////
+  /// @brief Also keep the screen depth of every projected vertex, larger
+  /// being nearer the viewer, for SoftwareRasterizer's z-buffer. Off by
+  /// default.
+  /////////////////////////////////////////////////
+  void SetKeepDepth(bool enabled);
+
+  /////////////////////////////////////////////////
+  /// @brief Print how many triangles each snapshot of a sweep culled. On
+  /// by default; turn it off when sweeping several fragments at once, as
+  /// their lines would interleave.
+  /////////////////////////////////////////////////
+  void SetSweepLogging(bool enabled);
+
+  size_t GetShapeCount() const;
+
+  /////////////////////////////////////////////////
+  /// @brief Triangle list of one projected shape, three vertices per
+  /// triangle, valid until the next sweep
+  /////////////////////////////////////////////////
+  std::span<const sf::Vertex> GetShape(size_t index) const;
+
+  /////////////////////////////////////////////////
+  /// @brief One depth per vertex of GetShape(index), empty if depth was not
+  /// kept, see SetKeepDepth
+  /////////////////////////////////////////////////
+  std::span<const float> GetShapeDepth(size_t index) const;
 
-  const std::vector<sf::VertexArray> &GetProjectedShapes() const;
+  /////////////////////////////////////////////////
+  /// @brief Bounds of a shape, see GetVertexBounds
+  /////////////////////////////////////////////////
+  sf::FloatRect GetShapeBounds(size_t index) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Vertices of all shapes back to back, for writers that want one
+  /// block. Shape i starts at GetShapeOffsets()[i] and ends where shape
+  /// i + 1 starts.
+  /////////////////////////////////////////////////
+  std::span<const sf::Vertex> GetVertexPool() const;
+
+  std::span<const size_t> GetShapeOffsets() const;
 
   void RotateFragmentAboutY(const Fragment3D &fragment,
                             const size_t rotation_intervals);
+
+  /////////////////////////////////////////////////
+  /// @brief The sweep of RotateFragmentAboutY as a lazy range that projects
+  /// each snapshot only when it is reached and stores none of them here.
+  /// The current settings apply as the range advances. The fragment and the
+  /// projector must outlive the range.
+  /////////////////////////////////////////////////
+  SnapshotSweep SweepFragmentAboutY(const Fragment3D &fragment,
+                                    const size_t rotation_intervals) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Project the sweep of RotateFragmentAboutY lazily and hand every
+  /// snapshot to a sink in angle order as soon as it is projected, so only
+  /// one snapshot is held here however long the sweep is
+  /////////////////////////////////////////////////
+  void StreamFragmentAboutY(const Fragment3D &fragment,
+                            const size_t rotation_intervals,
+                            SnapshotSink &sink) const;
+};
+
+/////////////////////////////////////////////////
+/// @brief Smallest rectangle holding every vertex, like
+/// sf::VertexArray::getBounds
+/////////////////////////////////////////////////
+sf::FloatRect GetVertexBounds(std::span<const sf::Vertex> vertices);
+
+/////////////////////////////////////////////////
+/// @class SnapshotSweep
+/// @brief Single pass range over the snapshots of a rotation sweep, see
+/// Projector::SweepFragmentAboutY.
+///
+/// Only the visibility index is built up front. Each snapshot is projected
+/// when the range reaches it, into buffers reused from step to step, so it
+/// stays valid until the range moves on and a sweep of any length holds one
+/// snapshot at a time. Snapshots are the same as the shapes of the eager
+/// sweep, and calling begin again replays them. The range can neither be
+/// copied nor moved, as its iterators point at it.
+/////////////////////////////////////////////////
+class SnapshotSweep {
+private:
+  friend class Projector;
+
+  const Projector &m_projector;
+
+  const Fragment3D &m_fragment;
+
+  glm::mat4 m_tilt;
+
+  glm::mat4 m_translate_to_origin;
+
+  glm::vec3 m_rotation_axis;
+
+  size_t m_rotation_intervals;
+
+  VisibilityIndex m_visibility;
+
+  std::vector<std::uint64_t> m_facing;
+
+  Projector::Scratch m_scratch;
+
+  std::vector<sf::Vertex> m_vertices;
+
+  std::vector<float> m_depth;
+
+  Snapshot m_current;
+
+  SnapshotSweep(const Projector &projector, const Fragment3D &fragment,
+                const float tilt_angle, const glm::vec3 tilt_axis,
+                const size_t rotation_intervals,
+                const glm::vec3 rotation_axis);
+
+  /////////////////////////////////////////////////
+  /// @brief Make step index the current snapshot, steps being visited in
+  /// order from 0. Past the last step the snapshot is empty.
+  /////////////////////////////////////////////////
+  void Project(size_t index);
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Input iterator over the snapshots, equal to the end sentinel
+  /// once every step has been visited
+  /////////////////////////////////////////////////
+  class Iterator {
+  private:
+    SnapshotSweep *m_sweep{nullptr};
+
+  public:
+    using value_type = Snapshot;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+
+    explicit Iterator(SnapshotSweep &sweep);
+
+    const Snapshot &operator*() const;
+
+    const Snapshot *operator->() const;
+
+    Iterator &operator++();
+
+    void operator++(int);
+
+    bool operator==(std::default_sentinel_t) const;
+  };
+
+  SnapshotSweep(const SnapshotSweep &) = delete;
+
+  SnapshotSweep &operator=(const SnapshotSweep &) = delete;
+
+  /////////////////////////////////////////////////
+  /// @brief Start the sweep over from step 0 and project that snapshot,
+  /// which moves any other iterator of the range along with it
+  /////////////////////////////////////////////////
+  Iterator begin();
+
+  std::default_sentinel_t end() const;
+
+  /////////////////////////////////////////////////
+  /// @brief Number of steps in the sweep
+  /////////////////////////////////////////////////
+  size_t size() const;
 };
 } // namespace projection_generator
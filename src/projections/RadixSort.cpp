@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the radix sort used to order triangles by depth
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "RadixSort.h"
+#include <cstddef>
+#include <utility>
+
+namespace projection_generator {
+
+namespace {
+
+constexpr unsigned kDigitBits = 11;
+
+constexpr size_t kNumBuckets = size_t{1} << kDigitBits;
+
+constexpr unsigned kNumPasses = (32 + kDigitBits - 1) / kDigitBits;
+
+/////////////////////////////////////////////////
+size_t GetDigit(std::uint64_t item, unsigned pass) {
+  return (item >> (32 + pass * kDigitBits)) & (kNumBuckets - 1);
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+void RadixSortByKey(std::vector<std::uint64_t> &items,
+                    RadixSortScratch &scratch) {
+  const size_t size = items.size();
+  if (size < 2)
+    return;
+
+  // the counts of every pass come from one read of the items
+  std::vector<size_t> &counts = scratch.m_counts;
+  counts.assign(kNumPasses * kNumBuckets, 0);
+  for (const std::uint64_t item : items) {
+    for (unsigned pass = 0; pass < kNumPasses; ++pass)
+      ++counts[pass * kNumBuckets + GetDigit(item, pass)];
+  }
+
+  std::vector<std::uint64_t> &sorted = scratch.m_sorted;
+  sorted.resize(size);
+  for (unsigned pass = 0; pass < kNumPasses; ++pass) {
+    size_t *starts = counts.data() + pass * kNumBuckets;
+    if (starts[GetDigit(items[0], pass)] == size)
+      continue; // every key has the same digit, the order stays as it is
+
+    size_t start = 0;
+    for (size_t bucket = 0; bucket < kNumBuckets; ++bucket)
+      start += std::exchange(starts[bucket], start);
+    for (const std::uint64_t item : items)
+      sorted[starts[GetDigit(item, pass)]++] = item;
+    items.swap(sorted);
+  }
+}
+
+} // namespace projection_generator
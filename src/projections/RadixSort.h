@@ -0,0 +1,62 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the radix sort used to order triangles by depth
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief Unsigned key that orders like the float it was made from: negative
+/// values have every bit flipped so larger magnitudes come first, positive
+/// values only the sign bit so they follow all negative ones
+/////////////////////////////////////////////////
+inline std::uint32_t GetSortableKey(float value) {
+  const auto bits = std::bit_cast<std::uint32_t>(value);
+  return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+}
+
+/////////////////////////////////////////////////
+/// @brief Item holding a sort key in its upper half and the value it orders
+/// in its lower half, so every pass moves one word per item
+/////////////////////////////////////////////////
+inline std::uint64_t MakeSortItem(std::uint32_t key, std::uint32_t value) {
+  return (std::uint64_t{key} << 32) | value;
+}
+
+/////////////////////////////////////////////////
+/// @brief Buffers RadixSortByKey reuses from call to call
+/////////////////////////////////////////////////
+struct RadixSortScratch {
+  /////////////////////////////////////////////////
+  /// @brief Target of every other pass, swapped with the items
+  /////////////////////////////////////////////////
+  std::vector<std::uint64_t> m_sorted;
+
+  /////////////////////////////////////////////////
+  /// @brief Bucket counts of every pass, one table after the other
+  /////////////////////////////////////////////////
+  std::vector<size_t> m_counts;
+};
+
+/////////////////////////////////////////////////
+/// @brief Stable sort of items by ascending key (see MakeSortItem) in three
+/// passes of eleven bits. Passes over a digit all keys share are skipped.
+/// Once scratch has grown to the largest input, sorting allocates nothing.
+/////////////////////////////////////////////////
+void RadixSortByKey(std::vector<std::uint64_t> &items,
+                    RadixSortScratch &scratch);
+
+} // namespace projection_generator
@@ -0,0 +1,55 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the Snapshot struct and the SnapshotSink interface
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <SFML/Graphics/Vertex.hpp>
+#include <cstddef>
+#include <span>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief One projected step of a sweep
+/////////////////////////////////////////////////
+struct Snapshot {
+  /////////////////////////////////////////////////
+  /// @brief Step of the sweep, 0 being the unrotated view
+  /////////////////////////////////////////////////
+  size_t m_index{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Three vertices per triangle, see Projector::GetShape
+  /////////////////////////////////////////////////
+  std::span<const sf::Vertex> m_vertices;
+
+  /////////////////////////////////////////////////
+  /// @brief One depth per vertex, empty unless Projector::SetKeepDepth
+  /////////////////////////////////////////////////
+  std::span<const float> m_depth;
+};
+
+/////////////////////////////////////////////////
+/// @class SnapshotSink
+/// @brief Receiver of the snapshots of a streamed sweep, see
+/// Projector::StreamFragmentAboutY
+/////////////////////////////////////////////////
+class SnapshotSink {
+public:
+  virtual ~SnapshotSink() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Consume one snapshot. Its spans are only valid for the call, so
+  /// anything kept has to be copied.
+  /////////////////////////////////////////////////
+  virtual void Write(const Snapshot &snapshot) = 0;
+};
+} // namespace projection_generator
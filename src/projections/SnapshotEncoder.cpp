@@ -0,0 +1,236 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the SnapshotEncoder class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "SnapshotEncoder.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+template <typename Bytes> void AppendVarint(Bytes &out, std::uint64_t value) {
+  using Byte = typename Bytes::value_type;
+  while (value >= 0x80) {
+    out.push_back(static_cast<Byte>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<Byte>(value));
+}
+
+/////////////////////////////////////////////////
+/// @brief Map a difference of two values, taken modulo 2^32, to an unsigned
+/// number that is small when the difference is small either way
+/////////////////////////////////////////////////
+std::uint32_t ZigZag(std::uint32_t difference) {
+  const std::int32_t signed_difference =
+      static_cast<std::int32_t>(difference);
+  return (difference << 1) ^
+         static_cast<std::uint32_t>(signed_difference >> 31);
+}
+
+/////////////////////////////////////////////////
+/// @brief Scale byte counts to frequencies adding up to kRansTotal, keeping
+/// every byte that occurs at 1 or more and none above kRansMaxFrequency
+/////////////////////////////////////////////////
+std::array<std::uint32_t, 256>
+NormalizeFrequencies(const std::array<std::uint64_t, 256> &counts,
+                     std::uint64_t total) {
+  std::array<std::uint32_t, 256> frequencies{};
+  std::uint32_t sum = 0;
+  size_t largest = 0;
+  for (size_t symbol = 0; symbol < 256; ++symbol) {
+    if (counts[symbol] == 0)
+      continue;
+    frequencies[symbol] = static_cast<std::uint32_t>(std::max<std::uint64_t>(
+        1, counts[symbol] * kRansTotal / total));
+    sum += frequencies[symbol];
+    if (counts[symbol] > counts[largest])
+      largest = symbol;
+  }
+
+  // rounding leaves the sum a little off, which the most common byte absorbs
+  // as it loses the least by it
+  if (sum < kRansTotal) {
+    frequencies[largest] += kRansTotal - sum;
+  } else {
+    while (sum > kRansTotal) {
+      const auto most = std::max_element(frequencies.begin(),
+                                         frequencies.end());
+      --*most;
+      --sum;
+    }
+  }
+
+  // the rest of a byte above the cap goes to the next most common byte, or
+  // to one that does not occur if it is the only byte
+  if (frequencies[largest] > kRansMaxFrequency) {
+    size_t other = largest == 0 ? 1 : 0;
+    for (size_t symbol = 0; symbol < 256; ++symbol) {
+      if (symbol != largest && counts[symbol] > counts[other])
+        other = symbol;
+    }
+    frequencies[other] += frequencies[largest] - kRansMaxFrequency;
+    frequencies[largest] = kRansMaxFrequency;
+  }
+  return frequencies;
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+std::uint32_t SnapshotEncoder::GetPaletteIndex(const sf::Color &color) {
+  std::uint32_t key;
+  std::memcpy(&key, &color, sizeof(key));
+  const auto [entry, inserted] = m_palette_indices.try_emplace(
+      key, static_cast<std::uint32_t>(m_palette.size()));
+  if (inserted)
+    m_palette.push_back({color.r, color.g, color.b, color.a});
+  return entry->second;
+}
+
+/////////////////////////////////////////////////
+void SnapshotEncoder::EncodeChannel(std::vector<std::byte> &out) {
+  m_bytes.clear();
+  std::uint32_t previous = 0;
+  for (const std::uint32_t value : m_values) {
+    AppendVarint(m_bytes, ZigZag(value - previous));
+    previous = value;
+  }
+
+  auto store_raw = [&]() {
+    out.push_back(static_cast<std::byte>(ChannelCoding::Raw));
+    AppendVarint(out, m_bytes.size());
+    const std::byte *bytes =
+        reinterpret_cast<const std::byte *>(m_bytes.data());
+    out.insert(out.end(), bytes, bytes + m_bytes.size());
+  };
+  if (m_bytes.size() < kMinRansBytes) {
+    store_raw();
+    return;
+  }
+
+  std::array<std::uint64_t, 256> counts{};
+  for (const std::uint8_t byte : m_bytes)
+    ++counts[byte];
+  const std::array<std::uint32_t, 256> frequencies =
+      NormalizeFrequencies(counts, m_bytes.size());
+  std::array<std::uint32_t, 256> starts{};
+  for (size_t symbol = 1; symbol < 256; ++symbol)
+    starts[symbol] = starts[symbol - 1] + frequencies[symbol - 1];
+
+  // rANS decodes in the opposite order to encoding, so the bytes are encoded
+  // back to front and the payload is built from its end
+  m_payload.resize(m_bytes.size() + 8);
+  size_t front = m_payload.size();
+  std::uint32_t state = kRansLowerBound;
+  for (size_t i = m_bytes.size(); i-- > 0;) {
+    const std::uint8_t symbol = m_bytes[i];
+    const std::uint32_t frequency = frequencies[symbol];
+    const std::uint32_t state_max =
+        ((kRansLowerBound >> kRansProbabilityBits) << 8) * frequency;
+    while (state >= state_max) {
+      if (front == 0) {
+        // incompressible, stored as it is instead
+        store_raw();
+        return;
+      }
+      m_payload[--front] = static_cast<std::uint8_t>(state & 0xff);
+      state >>= 8;
+    }
+    state = ((state / frequency) << kRansProbabilityBits) +
+            state % frequency + starts[symbol];
+  }
+  if (front < 4) {
+    store_raw();
+    return;
+  }
+  for (int shift = 24; shift >= 0; shift -= 8)
+    m_payload[--front] = static_cast<std::uint8_t>(state >> shift);
+  const size_t payload_size = m_payload.size() - front;
+
+  out.push_back(static_cast<std::byte>(ChannelCoding::Rans));
+  AppendVarint(out, m_bytes.size());
+  const size_t num_symbols = static_cast<size_t>(
+      std::count_if(frequencies.begin(), frequencies.end(),
+                    [](std::uint32_t frequency) { return frequency > 0; }));
+  AppendVarint(out, num_symbols);
+  for (size_t symbol = 0; symbol < 256; ++symbol) {
+    if (frequencies[symbol] == 0)
+      continue;
+    out.push_back(static_cast<std::byte>(symbol));
+    AppendVarint(out, frequencies[symbol]);
+  }
+  AppendVarint(out, payload_size);
+  const std::byte *payload =
+      reinterpret_cast<const std::byte *>(m_payload.data() + front);
+  out.insert(out.end(), payload, payload + payload_size);
+}
+
+/////////////////////////////////////////////////
+CompressedVertexFileEntry
+SnapshotEncoder::Encode(const Snapshot &snapshot,
+                        std::vector<std::byte> &out) {
+  const std::span<const sf::Vertex> vertices = snapshot.m_vertices;
+  const std::span<const float> depth = snapshot.m_depth;
+  if (!depth.empty() && depth.size() != vertices.size())
+    throw std::runtime_error("Snapshot has a depth count unlike its "
+                             "vertex count.");
+
+  CompressedVertexFileEntry entry{};
+  entry.m_index = snapshot.m_index;
+  entry.m_num_vertices = vertices.size();
+  entry.m_has_depth = depth.empty() ? 0 : 1;
+  if (!vertices.empty()) {
+    entry.m_min_x = entry.m_max_x = vertices.front().position.x;
+    entry.m_min_y = entry.m_max_y = vertices.front().position.y;
+  }
+  for (const sf::Vertex &vertex : vertices) {
+    entry.m_min_x = std::min(entry.m_min_x, vertex.position.x);
+    entry.m_min_y = std::min(entry.m_min_y, vertex.position.y);
+    entry.m_max_x = std::max(entry.m_max_x, vertex.position.x);
+    entry.m_max_y = std::max(entry.m_max_y, vertex.position.y);
+  }
+  if (!depth.empty()) {
+    const auto [min_depth, max_depth] =
+        std::minmax_element(depth.begin(), depth.end());
+    entry.m_min_depth = *min_depth;
+    entry.m_max_depth = *max_depth;
+  }
+
+  m_values.resize(vertices.size());
+  const double x_step = GetQuantizationStep(entry.m_min_x, entry.m_max_x);
+  for (size_t i = 0; i < vertices.size(); ++i)
+    m_values[i] = Quantize(entry.m_min_x, x_step, vertices[i].position.x);
+  EncodeChannel(out);
+  const double y_step = GetQuantizationStep(entry.m_min_y, entry.m_max_y);
+  for (size_t i = 0; i < vertices.size(); ++i)
+    m_values[i] = Quantize(entry.m_min_y, y_step, vertices[i].position.y);
+  EncodeChannel(out);
+  for (size_t i = 0; i < vertices.size(); ++i)
+    m_values[i] = GetPaletteIndex(vertices[i].color);
+  EncodeChannel(out);
+  if (!depth.empty()) {
+    const double depth_step =
+        GetQuantizationStep(entry.m_min_depth, entry.m_max_depth);
+    for (size_t i = 0; i < depth.size(); ++i)
+      m_values[i] = Quantize(entry.m_min_depth, depth_step, depth[i]);
+    EncodeChannel(out);
+  }
+  return entry;
+}
+
+/////////////////////////////////////////////////
+std::span<const VertexFileColor> SnapshotEncoder::GetPalette() const {
+  return m_palette;
+}
+
+} // namespace projection_generator
@@ -0,0 +1,73 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the SnapshotEncoder class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "CompressedVertexFile.h"
+#include "Snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class SnapshotEncoder
+/// @brief Encodes the snapshots of one compressed vertex file, see
+/// CompressedVertexFile.h. Colors are numbered in the order they are first
+/// seen, so the palette is complete once every snapshot of the file has
+/// been encoded.
+/////////////////////////////////////////////////
+class SnapshotEncoder {
+private:
+  std::vector<VertexFileColor> m_palette;
+
+  std::unordered_map<std::uint32_t, std::uint32_t> m_palette_indices;
+
+  /////////////////////////////////////////////////
+  /// @brief Values of the channel being encoded
+  /////////////////////////////////////////////////
+  std::vector<std::uint32_t> m_values;
+
+  /////////////////////////////////////////////////
+  /// @brief Varint bytes of the channel being encoded
+  /////////////////////////////////////////////////
+  std::vector<std::uint8_t> m_bytes;
+
+  /////////////////////////////////////////////////
+  /// @brief rANS payload, written back to front
+  /////////////////////////////////////////////////
+  std::vector<std::uint8_t> m_payload;
+
+  /////////////////////////////////////////////////
+  /// @brief Append the channel of m_values to out
+  /////////////////////////////////////////////////
+  void EncodeChannel(std::vector<std::byte> &out);
+
+  std::uint32_t GetPaletteIndex(const sf::Color &color);
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Append the channels of a snapshot to out
+  ///
+  /// @return The snapshot's table entry, apart from m_offset and m_size
+  /////////////////////////////////////////////////
+  CompressedVertexFileEntry Encode(const Snapshot &snapshot,
+                                   std::vector<std::byte> &out);
+
+  /////////////////////////////////////////////////
+  /// @brief Every color encoded so far, indexed by the color channels
+  /////////////////////////////////////////////////
+  std::span<const VertexFileColor> GetPalette() const;
+};
+} // namespace projection_generator
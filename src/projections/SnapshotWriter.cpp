@@ -0,0 +1,312 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the SnapshotWriter class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "SnapshotWriter.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace projection_generator {
+
+namespace {
+
+static_assert(sizeof(sf::Color) == sizeof(VertexFileColor),
+              "vertex files assume packed colors");
+
+/////////////////////////////////////////////////
+/// @brief Pass get(0) to get(count - 1) to append a block at a time, which
+/// turns the vertices' interleaved fields into the file's arrays without
+/// a copy of the whole snapshot
+/////////////////////////////////////////////////
+template <typename T, typename Get, typename Append>
+void AppendGathered(size_t count, Get get, Append append) {
+  std::array<T, 1024> block;
+  for (size_t first = 0; first < count; first += block.size()) {
+    const size_t num_values = std::min(block.size(), count - first);
+    for (size_t i = 0; i < num_values; ++i)
+      block[i] = get(first + i);
+    append(block.data(), num_values * sizeof(T));
+  }
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+SnapshotWriter::SnapshotWriter(const std::filesystem::path &file_path,
+                               VertexFileEncoding encoding,
+                               size_t buffer_size)
+    : m_file(file_path, std::ios::binary | std::ios::trunc),
+      m_file_path(file_path), m_encoding(encoding),
+      m_buffer_size(std::max<size_t>(buffer_size, 1)) {
+  if (!m_file) {
+    throw std::runtime_error("Could not open snapshot file: " +
+                             file_path.string());
+  }
+  m_filling.reserve(m_buffer_size);
+  m_writing.reserve(m_buffer_size);
+  m_io_thread = std::thread([this]() { IoLoop(); });
+
+  // filled in by Close, both headers having the same size
+  static_assert(sizeof(VertexFileHeader) ==
+                sizeof(CompressedVertexFileHeader));
+  const VertexFileHeader header{};
+  Append(&header, sizeof(header));
+}
+
+/////////////////////////////////////////////////
+SnapshotWriter::~SnapshotWriter() {
+  if (!m_io_thread.joinable())
+    return;
+
+  // unwinding from a failed sweep must not pass the file off as complete,
+  // so the header stays zeroed and what is still buffered is dropped
+  StopIo();
+  m_file.close();
+  std::cerr << "[ERROR] SnapshotWriter: Not closed, left incomplete: "
+            << m_file_path.string() << std::endl;
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::StopIo() {
+  {
+    std::lock_guard lock(m_mutex);
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+  m_io_thread.join();
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::IoLoop() {
+  std::unique_lock lock(m_mutex);
+  while (true) {
+    m_condition.wait(lock, [this]() { return m_pending || m_stopping; });
+    if (!m_pending)
+      return;
+
+    // m_writing and m_file are left to this thread while m_pending is set
+    lock.unlock();
+    m_file.write(reinterpret_cast<const char *>(m_writing.data()),
+                 static_cast<std::streamsize>(m_writing.size()));
+    const bool failed = !m_file;
+    lock.lock();
+
+    if (failed && !m_error) {
+      m_error = std::make_exception_ptr(std::runtime_error(
+          "Could not write snapshot file: " + m_file_path.string()));
+    } else if (!failed) {
+      m_bytes_written += m_writing.size();
+    }
+    m_writing.clear();
+    m_pending = false;
+    m_condition.notify_all();
+  }
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::WaitForIo() {
+  std::unique_lock lock(m_mutex);
+  m_condition.wait(lock, [this]() { return !m_pending; });
+  if (m_error)
+    std::rethrow_exception(m_error);
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::HandOver() {
+  if (m_filling.empty())
+    return;
+  WaitForIo();
+  {
+    std::lock_guard lock(m_mutex);
+    std::swap(m_filling, m_writing);
+    m_pending = true;
+  }
+  m_condition.notify_all();
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::Append(const void *data, size_t size) {
+  const std::byte *bytes = static_cast<const std::byte *>(data);
+  while (size > 0) {
+    const size_t num_bytes = std::min(size, m_buffer_size - m_filling.size());
+    m_filling.insert(m_filling.end(), bytes, bytes + num_bytes);
+    bytes += num_bytes;
+    size -= num_bytes;
+    m_offset += num_bytes;
+    if (m_filling.size() == m_buffer_size)
+      HandOver();
+  }
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::AppendPadding() {
+  constexpr std::array<std::byte, kVertexFileAlignment> kZeros{};
+  const std::uint64_t remainder = m_offset % kVertexFileAlignment;
+  if (remainder != 0)
+    Append(kZeros.data(), kVertexFileAlignment - remainder);
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::Write(const Snapshot &snapshot) {
+  if (!m_io_thread.joinable())
+    throw std::runtime_error("Snapshot file is already closed.");
+  if (m_encoding == VertexFileEncoding::Compressed)
+    WriteCompressed(snapshot);
+  else
+    WriteRaw(snapshot);
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::WriteCompressed(const Snapshot &snapshot) {
+  m_encoded.clear();
+  CompressedVertexFileEntry entry = m_encoder.Encode(snapshot, m_encoded);
+  entry.m_offset = m_offset;
+  entry.m_size = m_encoded.size();
+  Append(m_encoded.data(), m_encoded.size());
+  m_compressed_entries.push_back(entry);
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::WriteRaw(const Snapshot &snapshot) {
+  const std::span<const sf::Vertex> vertices = snapshot.m_vertices;
+  // checked before anything is appended, so a rejected snapshot leaves the
+  // file as it was
+  if (!snapshot.m_depth.empty() && snapshot.m_depth.size() != vertices.size())
+    throw std::runtime_error("Snapshot has a depth count unlike its "
+                             "vertex count.");
+  VertexFileEntry entry{};
+  entry.m_index = snapshot.m_index;
+  entry.m_num_vertices = vertices.size();
+  if (!vertices.empty()) {
+    entry.m_min_x = entry.m_max_x = vertices.front().position.x;
+    entry.m_min_y = entry.m_max_y = vertices.front().position.y;
+  }
+
+  auto append = [this](const void *data, size_t size) { Append(data, size); };
+  AppendPadding();
+  entry.m_x_offset = m_offset;
+  AppendGathered<float>(
+      vertices.size(),
+      [&](size_t i) {
+        const float x = vertices[i].position.x;
+        entry.m_min_x = std::min(entry.m_min_x, x);
+        entry.m_max_x = std::max(entry.m_max_x, x);
+        return x;
+      },
+      append);
+  AppendPadding();
+  entry.m_y_offset = m_offset;
+  AppendGathered<float>(
+      vertices.size(),
+      [&](size_t i) {
+        const float y = vertices[i].position.y;
+        entry.m_min_y = std::min(entry.m_min_y, y);
+        entry.m_max_y = std::max(entry.m_max_y, y);
+        return y;
+      },
+      append);
+  AppendPadding();
+  entry.m_color_offset = m_offset;
+  AppendGathered<sf::Color>(
+      vertices.size(), [&](size_t i) { return vertices[i].color; }, append);
+
+  if (!snapshot.m_depth.empty()) {
+    AppendPadding();
+    entry.m_depth_offset = m_offset;
+    append(snapshot.m_depth.data(), snapshot.m_depth.size_bytes());
+  }
+  m_entries.push_back(entry);
+}
+
+/////////////////////////////////////////////////
+VertexFileHeader SnapshotWriter::FinishRaw() {
+  AppendPadding();
+  VertexFileHeader header{};
+  header.m_magic = kVertexFileMagic;
+  header.m_version = kVertexFileVersion;
+  header.m_byte_order = kVertexFileByteOrder;
+  header.m_num_snapshots = m_entries.size();
+  header.m_table_offset = m_offset;
+  Append(m_entries.data(), m_entries.size() * sizeof(VertexFileEntry));
+  header.m_file_size = m_offset;
+  return header;
+}
+
+/////////////////////////////////////////////////
+CompressedVertexFileHeader SnapshotWriter::FinishCompressed() {
+  const std::span<const VertexFileColor> palette = m_encoder.GetPalette();
+  CompressedVertexFileHeader header{};
+  header.m_magic = kCompressedVertexFileMagic;
+  header.m_version = kCompressedVertexFileVersion;
+  header.m_byte_order = kVertexFileByteOrder;
+  header.m_num_snapshots = m_compressed_entries.size();
+  header.m_num_colors = palette.size();
+  AppendPadding();
+  header.m_palette_offset = m_offset;
+  Append(palette.data(), palette.size_bytes());
+  AppendPadding();
+  header.m_table_offset = m_offset;
+  Append(m_compressed_entries.data(),
+         m_compressed_entries.size() * sizeof(CompressedVertexFileEntry));
+  header.m_file_size = m_offset;
+  return header;
+}
+
+/////////////////////////////////////////////////
+void SnapshotWriter::Close() {
+  if (!m_io_thread.joinable())
+    return;
+
+  // the thread is stopped and the file closed even if the last writes fail
+  std::exception_ptr error;
+  try {
+    // the headers are built before the tables are handed over, as those
+    // move m_offset to the end of the file
+    std::array<char, sizeof(VertexFileHeader)> header;
+    if (m_encoding == VertexFileEncoding::Compressed) {
+      const CompressedVertexFileHeader compressed = FinishCompressed();
+      std::memcpy(header.data(), &compressed, sizeof(compressed));
+    } else {
+      const VertexFileHeader raw = FinishRaw();
+      std::memcpy(header.data(), &raw, sizeof(raw));
+    }
+    HandOver();
+    WaitForIo();
+
+    // the background thread is idle, so the file is ours again
+    m_file.seekp(0);
+    m_file.write(header.data(), header.size());
+    if (!m_file) {
+      throw std::runtime_error("Could not write snapshot file: " +
+                               m_file_path.string());
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  StopIo();
+
+  m_file.close();
+  if (!error && !m_file) {
+    error = std::make_exception_ptr(std::runtime_error(
+        "Could not close snapshot file: " + m_file_path.string()));
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+/////////////////////////////////////////////////
+std::uint64_t SnapshotWriter::GetBytesWritten() {
+  std::lock_guard lock(m_mutex);
+  return m_bytes_written;
+}
+
+} // namespace projection_generator
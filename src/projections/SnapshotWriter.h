@@ -0,0 +1,194 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the SnapshotWriter class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "Snapshot.h"
+#include "SnapshotEncoder.h"
+#include "VertexFile.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief File format SnapshotWriter writes
+/////////////////////////////////////////////////
+enum class VertexFileEncoding {
+  /////////////////////////////////////////////////
+  /// @brief Vertex file to be used in place, see VertexFile.h
+  /////////////////////////////////////////////////
+  Raw,
+
+  /////////////////////////////////////////////////
+  /// @brief Quantized and entropy coded, see CompressedVertexFile.h
+  /////////////////////////////////////////////////
+  Compressed
+};
+
+/////////////////////////////////////////////////
+/// @class SnapshotWriter
+/// @brief Sink that streams snapshots to a vertex file (see VertexFile.h
+/// and CompressedVertexFile.h) while the sweep goes on.
+///
+/// Snapshots are copied into one of two fixed size buffers. When it fills,
+/// it is handed to a background thread that writes it out while the other
+/// buffer takes the next snapshots, so projection and I/O overlap. If the
+/// disk falls behind, Write waits for the background thread, so memory
+/// stays at the two buffers however much the sweep produces.
+///
+/// The header is left zeroed until Close writes the snapshot table and
+/// fills it in, so a file whose sweep was cut short is never taken for a
+/// complete one. Only Close completes the file; destroying the writer
+/// without it, as when a sweep throws, leaves the file incomplete.
+/////////////////////////////////////////////////
+class SnapshotWriter : public SnapshotSink {
+private:
+  std::ofstream m_file;
+
+  std::filesystem::path m_file_path;
+
+  VertexFileEncoding m_encoding;
+
+  /////////////////////////////////////////////////
+  /// @brief Buffer Write copies into
+  /////////////////////////////////////////////////
+  std::vector<std::byte> m_filling;
+
+  /////////////////////////////////////////////////
+  /// @brief Buffer owned by the background thread while m_pending is set
+  /////////////////////////////////////////////////
+  std::vector<std::byte> m_writing;
+
+  size_t m_buffer_size;
+
+  std::uint64_t m_bytes_written{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Offset in the file of the next byte Append takes
+  /////////////////////////////////////////////////
+  std::uint64_t m_offset{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Table entry of every snapshot written so far
+  /////////////////////////////////////////////////
+  std::vector<VertexFileEntry> m_entries;
+
+  std::vector<CompressedVertexFileEntry> m_compressed_entries;
+
+  SnapshotEncoder m_encoder;
+
+  /////////////////////////////////////////////////
+  /// @brief Channels of the snapshot being compressed
+  /////////////////////////////////////////////////
+  std::vector<std::byte> m_encoded;
+
+  std::mutex m_mutex;
+
+  std::condition_variable m_condition;
+
+  bool m_pending{false};
+
+  bool m_stopping{false};
+
+  /////////////////////////////////////////////////
+  /// @brief First failure of the background thread, rethrown by the next
+  /// Write or Close
+  /////////////////////////////////////////////////
+  std::exception_ptr m_error;
+
+  std::thread m_io_thread;
+
+  void IoLoop();
+
+  /////////////////////////////////////////////////
+  /// @brief Copy bytes into m_filling, handing it over whenever it fills
+  /////////////////////////////////////////////////
+  void Append(const void *data, size_t size);
+
+  /////////////////////////////////////////////////
+  /// @brief Append zeros up to the next kVertexFileAlignment boundary
+  /////////////////////////////////////////////////
+  void AppendPadding();
+
+  /////////////////////////////////////////////////
+  /// @brief Wait until the background thread is idle, then give it
+  /// m_filling to write
+  /////////////////////////////////////////////////
+  void HandOver();
+
+  /////////////////////////////////////////////////
+  /// @brief Wait until the background thread is idle and rethrow its error
+  /////////////////////////////////////////////////
+  void WaitForIo();
+
+  /////////////////////////////////////////////////
+  /// @brief Let the background thread finish its buffer, then join it
+  /////////////////////////////////////////////////
+  void StopIo();
+
+  void WriteRaw(const Snapshot &snapshot);
+
+  void WriteCompressed(const Snapshot &snapshot);
+
+  /////////////////////////////////////////////////
+  /// @brief Append the tables that end the file and return its header
+  /////////////////////////////////////////////////
+  VertexFileHeader FinishRaw();
+
+  CompressedVertexFileHeader FinishCompressed();
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Constructor, creates or truncates the file and starts the
+  /// background thread
+  ///
+  /// @param file_path File to write
+  /// @param encoding Format of the file
+  /// @param buffer_size Bytes per buffer, two of which are allocated
+  /////////////////////////////////////////////////
+  explicit SnapshotWriter(
+      const std::filesystem::path &file_path,
+      VertexFileEncoding encoding = VertexFileEncoding::Raw,
+      size_t buffer_size = size_t{8} << 20);
+
+  SnapshotWriter(const SnapshotWriter &) = delete;
+
+  SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+  /////////////////////////////////////////////////
+  /// @brief If Close was not called, stops the background thread and
+  /// leaves the file incomplete, with its header zeroed
+  /////////////////////////////////////////////////
+  ~SnapshotWriter() override;
+
+  void Write(const Snapshot &snapshot) override;
+
+  /////////////////////////////////////////////////
+  /// @brief Write what is still buffered and the snapshot table, stop the
+  /// background thread, fill in the header and close the file, throwing
+  /// std::runtime_error if any write failed
+  /////////////////////////////////////////////////
+  void Close();
+
+  /////////////////////////////////////////////////
+  /// @brief Bytes handed to the file so far, buffered ones excluded
+  /////////////////////////////////////////////////
+  std::uint64_t GetBytesWritten();
+};
+} // namespace projection_generator
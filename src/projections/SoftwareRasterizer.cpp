@@ -0,0 +1,462 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the SoftwareRasterizer class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#define SOFTWARE_RASTERIZER_X86 1
+#include <immintrin.h>
+#else
+#define SOFTWARE_RASTERIZER_X86 0
+#endif
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Side of a square tile in pixels. A tile of colors and depths is
+/// 32 KiB, which stays in the first or second level cache while it is
+/// filled.
+/////////////////////////////////////////////////
+constexpr unsigned kTileSize = 64;
+
+/////////////////////////////////////////////////
+/// @brief Triangles set up and binned by one task
+/////////////////////////////////////////////////
+constexpr size_t kSetupGrain = 1 << 12;
+
+/////////////////////////////////////////////////
+/// @brief A triangle in pixel space, ready to be filled.
+///
+/// Edge i is the one opposite corner i, with edge function
+/// w_i = a_i x + b_i y + c_i positive inside. w_1 and w_2 over twice the
+/// area are the weights of corners 1 and 2, which interpolate depth and
+/// color from corner 0 as base + w_1 d_1 + w_2 d_2.
+/////////////////////////////////////////////////
+struct TriangleSetup {
+  std::array<float, 3> m_a{};
+
+  std::array<float, 3> m_b{};
+
+  std::array<float, 3> m_c{};
+
+  /////////////////////////////////////////////////
+  /// @brief Whether pixel centres exactly on edge i are covered, true for
+  /// exactly one of the two triangles sharing an edge
+  /////////////////////////////////////////////////
+  std::array<bool, 3> m_owns_edge{};
+
+  float m_inv_area{0.0f};
+
+  std::array<float, 3> m_depth{};
+
+  std::array<std::array<float, 3>, 4> m_color{};
+
+  /////////////////////////////////////////////////
+  /// @brief Inclusive pixel bounds, empty when min > max
+  /////////////////////////////////////////////////
+  int m_min_x{0};
+
+  int m_min_y{0};
+
+  int m_max_x{-1};
+
+  int m_max_y{-1};
+};
+
+/////////////////////////////////////////////////
+/// @brief Pack a color in sf::Image's byte order
+/////////////////////////////////////////////////
+std::uint32_t PackColor(std::uint32_t r, std::uint32_t g, std::uint32_t b,
+                        std::uint32_t a) {
+  if constexpr (std::endian::native == std::endian::little)
+    return r | (g << 8) | (b << 16) | (a << 24);
+  else
+    return (r << 24) | (g << 16) | (b << 8) | a;
+}
+
+/////////////////////////////////////////////////
+/// @brief First and last pixel whose centre lies in [low, high], clamped to
+/// [0, size - 1]
+/////////////////////////////////////////////////
+std::pair<int, int> GetPixelRange(float low, float high, unsigned size) {
+  const float first = std::max(0.0f, std::ceil(low - 0.5f));
+  const float last =
+      std::min(static_cast<float>(size) - 1.0f, std::floor(high - 0.5f));
+  if (!(first <= last))
+    return {0, -1};
+  return {static_cast<int>(first), static_cast<int>(last)};
+}
+
+/////////////////////////////////////////////////
+TriangleSetup SetupTriangle(std::array<sf::Vector2f, 3> position,
+                            std::array<float, 3> depth,
+                            std::array<sf::Color, 3> color,
+                            sf::Vector2u size) {
+  TriangleSetup setup;
+  auto cross = [&]() {
+    return (position[1].x - position[0].x) * (position[2].y - position[0].y) -
+           (position[1].y - position[0].y) * (position[2].x - position[0].x);
+  };
+  float area = cross();
+  if (!std::isfinite(area) || area == 0.0f)
+    return setup; // no area, or off in infinity
+  if (area < 0.0f) {
+    // make every edge function positive inside
+    std::swap(position[1], position[2]);
+    std::swap(depth[1], depth[2]);
+    std::swap(color[1], color[2]);
+    area = cross();
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    const sf::Vector2f &from = position[(i + 1) % 3];
+    const sf::Vector2f &to = position[(i + 2) % 3];
+    setup.m_a[i] = from.y - to.y;
+    setup.m_b[i] = to.x - from.x;
+    setup.m_c[i] = from.x * to.y - from.y * to.x;
+    // the triangle across the edge has both coefficients negated, so
+    // exactly one of the two passes this
+    setup.m_owns_edge[i] =
+        setup.m_a[i] > 0.0f || (setup.m_a[i] == 0.0f && setup.m_b[i] > 0.0f);
+  }
+  setup.m_inv_area = 1.0f / area;
+  setup.m_depth = {depth[0], depth[1] - depth[0], depth[2] - depth[0]};
+  const std::array<std::array<float, 3>, 4> channels{{
+      {float(color[0].r), float(color[1].r), float(color[2].r)},
+      {float(color[0].g), float(color[1].g), float(color[2].g)},
+      {float(color[0].b), float(color[1].b), float(color[2].b)},
+      {float(color[0].a), float(color[1].a), float(color[2].a)},
+  }};
+  for (size_t k = 0; k < 4; ++k) {
+    const std::array<float, 3> &c = channels[k];
+    setup.m_color[k] = {c[0], c[1] - c[0], c[2] - c[0]};
+  }
+
+  const auto [min_x, max_x] =
+      GetPixelRange(std::min({position[0].x, position[1].x, position[2].x}),
+                    std::max({position[0].x, position[1].x, position[2].x}),
+                    size.x);
+  const auto [min_y, max_y] =
+      GetPixelRange(std::min({position[0].y, position[1].y, position[2].y}),
+                    std::max({position[0].y, position[1].y, position[2].y}),
+                    size.y);
+  if (min_x <= max_x && min_y <= max_y) {
+    setup.m_min_x = min_x;
+    setup.m_max_x = max_x;
+    setup.m_min_y = min_y;
+    setup.m_max_y = max_y;
+  }
+  return setup;
+}
+
+/////////////////////////////////////////////////
+bool Covers(float w, bool owns_edge) {
+  return w > 0.0f || (w == 0.0f && owns_edge);
+}
+
+/////////////////////////////////////////////////
+/// @brief Interpolate one channel and round it to a byte
+/////////////////////////////////////////////////
+std::uint32_t ToByte(const std::array<float, 3> &channel, float l1,
+                     float l2) {
+  const float value = channel[0] + l1 * channel[1] + l2 * channel[2];
+  return static_cast<std::uint32_t>(
+      std::lrint(std::min(std::max(value, 0.0f), 255.0f)));
+}
+
+/////////////////////////////////////////////////
+/// @brief Fill pixels first to last of row y. Every expression matches the
+/// vector version operation for operation.
+/////////////////////////////////////////////////
+void FillSpanScalar(const TriangleSetup &setup, int y, int first, int last,
+                    std::uint32_t *color, float *depth, bool use_depth) {
+  const float py = static_cast<float>(y) + 0.5f;
+  std::array<float, 3> row_offset;
+  for (size_t i = 0; i < 3; ++i)
+    row_offset[i] = setup.m_b[i] * py;
+
+  for (int x = first; x <= last; ++x) {
+    const float px = static_cast<float>(x) + 0.5f;
+    std::array<float, 3> w;
+    bool inside = true;
+    for (size_t i = 0; i < 3; ++i) {
+      w[i] = setup.m_a[i] * px + row_offset[i] + setup.m_c[i];
+      inside = inside && Covers(w[i], setup.m_owns_edge[i]);
+    }
+    if (!inside)
+      continue;
+
+    const float l1 = w[1] * setup.m_inv_area;
+    const float l2 = w[2] * setup.m_inv_area;
+    if (use_depth) {
+      const float z =
+          setup.m_depth[0] + l1 * setup.m_depth[1] + l2 * setup.m_depth[2];
+      if (!(z > depth[x]))
+        continue;
+      depth[x] = z;
+    }
+    color[x] = PackColor(ToByte(setup.m_color[0], l1, l2),
+                         ToByte(setup.m_color[1], l1, l2),
+                         ToByte(setup.m_color[2], l1, l2),
+                         ToByte(setup.m_color[3], l1, l2));
+  }
+}
+
+#if SOFTWARE_RASTERIZER_X86
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2"))) __m256i
+ToBytesAvx2(const std::array<float, 3> &channel, __m256 l1, __m256 l2) {
+  const __m256 value = _mm256_add_ps(
+      _mm256_add_ps(_mm256_set1_ps(channel[0]),
+                    _mm256_mul_ps(l1, _mm256_set1_ps(channel[1]))),
+      _mm256_mul_ps(l2, _mm256_set1_ps(channel[2])));
+  const __m256 clamped = _mm256_min_ps(
+      _mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+  return _mm256_cvtps_epi32(clamped); // rounds to nearest even like lrint
+}
+
+/////////////////////////////////////////////////
+/// @brief FillSpanScalar for eight pixels per iteration, with lanes past
+/// the span masked off
+/////////////////////////////////////////////////
+__attribute__((target("avx2"))) void
+FillSpanAvx2(const TriangleSetup &setup, int y, int first, int last,
+             std::uint32_t *color, float *depth, bool use_depth) {
+  const float py = static_cast<float>(y) + 0.5f;
+  __m256 a[3];
+  __m256 row_offset[3];
+  __m256 c[3];
+  __m256 owns_edge[3];
+  for (size_t i = 0; i < 3; ++i) {
+    a[i] = _mm256_set1_ps(setup.m_a[i]);
+    row_offset[i] = _mm256_set1_ps(setup.m_b[i] * py);
+    c[i] = _mm256_set1_ps(setup.m_c[i]);
+    owns_edge[i] = _mm256_castsi256_ps(
+        _mm256_set1_epi32(setup.m_owns_edge[i] ? -1 : 0));
+  }
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 inv_area = _mm256_set1_ps(setup.m_inv_area);
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i end = _mm256_set1_epi32(last + 1);
+
+  for (int x = first; x <= last; x += 8) {
+    const __m256i columns = _mm256_add_epi32(_mm256_set1_epi32(x), lanes);
+    const __m256 px =
+        _mm256_add_ps(_mm256_cvtepi32_ps(columns), _mm256_set1_ps(0.5f));
+    __m256 inside = _mm256_castsi256_ps(_mm256_cmpgt_epi32(end, columns));
+    __m256 w[3];
+    for (size_t i = 0; i < 3; ++i) {
+      w[i] = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(a[i], px), row_offset[i]), c[i]);
+      const __m256 covers = _mm256_or_ps(
+          _mm256_cmp_ps(w[i], zero, _CMP_GT_OQ),
+          _mm256_and_ps(_mm256_cmp_ps(w[i], zero, _CMP_EQ_OQ), owns_edge[i]));
+      inside = _mm256_and_ps(inside, covers);
+    }
+    if (_mm256_movemask_ps(inside) == 0)
+      continue;
+
+    const __m256 l1 = _mm256_mul_ps(w[1], inv_area);
+    const __m256 l2 = _mm256_mul_ps(w[2], inv_area);
+    if (use_depth) {
+      const __m256 z = _mm256_add_ps(
+          _mm256_add_ps(_mm256_set1_ps(setup.m_depth[0]),
+                        _mm256_mul_ps(l1, _mm256_set1_ps(setup.m_depth[1]))),
+          _mm256_mul_ps(l2, _mm256_set1_ps(setup.m_depth[2])));
+      const __m256 stored =
+          _mm256_maskload_ps(depth + x, _mm256_castps_si256(inside));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(z, stored, _CMP_GT_OQ));
+      if (_mm256_movemask_ps(inside) == 0)
+        continue;
+      _mm256_maskstore_ps(depth + x, _mm256_castps_si256(inside), z);
+    }
+
+    const __m256i r = ToBytesAvx2(setup.m_color[0], l1, l2);
+    const __m256i g = ToBytesAvx2(setup.m_color[1], l1, l2);
+    const __m256i b = ToBytesAvx2(setup.m_color[2], l1, l2);
+    const __m256i alpha = ToBytesAvx2(setup.m_color[3], l1, l2);
+    // x86 is little endian, see PackColor
+    const __m256i packed = _mm256_or_si256(
+        _mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+        _mm256_or_si256(_mm256_slli_epi32(b, 16),
+                        _mm256_slli_epi32(alpha, 24)));
+    _mm256_maskstore_epi32(reinterpret_cast<int *>(color + x),
+                           _mm256_castps_si256(inside), packed);
+  }
+}
+
+#endif
+
+} // namespace
+
+/////////////////////////////////////////////////
+SoftwareRasterizer::SoftwareRasterizer(sf::Vector2u size,
+                                       ThreadPool &thread_pool)
+    : m_thread_pool(thread_pool), m_size(size),
+      m_color(static_cast<size_t>(size.x) * size.y),
+      m_depth(static_cast<size_t>(size.x) * size.y) {
+  Clear();
+}
+
+/////////////////////////////////////////////////
+void SoftwareRasterizer::Clear(sf::Color background) {
+  std::fill(m_color.begin(), m_color.end(),
+            PackColor(background.r, background.g, background.b,
+                      background.a));
+  std::fill(m_depth.begin(), m_depth.end(),
+            -std::numeric_limits<float>::infinity());
+}
+
+/////////////////////////////////////////////////
+void SoftwareRasterizer::Draw(std::span<const sf::Vertex> triangles,
+                              std::span<const float> depth,
+                              const sf::FloatRect &area) {
+  if (!depth.empty() && depth.size() != triangles.size()) {
+    throw std::runtime_error(
+        "SoftwareRasterizer needs one depth per vertex or none.");
+  }
+  const size_t num_triangles = triangles.size() / 3;
+  if (num_triangles == 0 || m_color.empty() || area.size.x == 0.0f ||
+      area.size.y == 0.0f) {
+    return;
+  }
+  const bool use_depth = !depth.empty();
+  const float scale_x = static_cast<float>(m_size.x) / area.size.x;
+  const float scale_y = static_cast<float>(m_size.y) / area.size.y;
+
+  const unsigned tiles_x = (m_size.x + kTileSize - 1) / kTileSize;
+  const unsigned tiles_y = (m_size.y + kTileSize - 1) / kTileSize;
+  const size_t num_tiles = static_cast<size_t>(tiles_x) * tiles_y;
+  const size_t num_chunks = (num_triangles + kSetupGrain - 1) / kSetupGrain;
+
+  // Step 1: set up every triangle and count how many each chunk of them
+  // puts in every tile
+  std::vector<TriangleSetup> setups(num_triangles);
+  std::vector<size_t> bin_offsets(num_chunks * num_tiles, 0);
+  auto for_each_tile = [&](const TriangleSetup &setup, auto visit) {
+    if (setup.m_min_x > setup.m_max_x)
+      return;
+    for (unsigned ty = static_cast<unsigned>(setup.m_min_y) / kTileSize;
+         ty <= static_cast<unsigned>(setup.m_max_y) / kTileSize; ++ty) {
+      for (unsigned tx = static_cast<unsigned>(setup.m_min_x) / kTileSize;
+           tx <= static_cast<unsigned>(setup.m_max_x) / kTileSize; ++tx)
+        visit(static_cast<size_t>(ty) * tiles_x + tx);
+    }
+  };
+  m_thread_pool.ParallelFor(
+      0, num_triangles, kSetupGrain, [&](size_t first, size_t last) {
+        size_t *counts = &bin_offsets[(first / kSetupGrain) * num_tiles];
+        for (size_t t = first; t < last; ++t) {
+          std::array<sf::Vector2f, 3> position;
+          std::array<float, 3> z{};
+          std::array<sf::Color, 3> color;
+          for (size_t corner = 0; corner < 3; ++corner) {
+            const sf::Vertex &vertex = triangles[t * 3 + corner];
+            position[corner] = {
+                (vertex.position.x - area.position.x) * scale_x,
+                (vertex.position.y - area.position.y) * scale_y};
+            color[corner] = vertex.color;
+            if (use_depth)
+              z[corner] = depth[t * 3 + corner];
+          }
+          setups[t] = SetupTriangle(position, z, color, m_size);
+          for_each_tile(setups[t], [&](size_t tile) { ++counts[tile]; });
+        }
+      });
+
+  // Step 2: bin the triangles, tile by tile and within a tile in
+  // submission order
+  std::vector<size_t> tile_starts(num_tiles + 1, 0);
+  size_t num_binned = 0;
+  for (size_t tile = 0; tile < num_tiles; ++tile) {
+    tile_starts[tile] = num_binned;
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+      num_binned += std::exchange(bin_offsets[chunk * num_tiles + tile],
+                                  num_binned);
+  }
+  tile_starts[num_tiles] = num_binned;
+  std::vector<size_t> bins(num_binned);
+  m_thread_pool.ParallelFor(
+      0, num_triangles, kSetupGrain, [&](size_t first, size_t last) {
+        size_t *cursors = &bin_offsets[(first / kSetupGrain) * num_tiles];
+        for (size_t t = first; t < last; ++t) {
+          for_each_tile(setups[t],
+                        [&](size_t tile) { bins[cursors[tile]++] = t; });
+        }
+      });
+
+  // Step 3: fill the tiles, each on one thread
+  [[maybe_unused]] const bool use_avx2 = m_simd_level == SimdLevel::Avx2;
+  m_thread_pool.ParallelFor(0, num_tiles, 1, [&](size_t first, size_t last) {
+    for (size_t tile = first; tile < last; ++tile) {
+      const int tile_min_x = static_cast<int>((tile % tiles_x) * kTileSize);
+      const int tile_min_y = static_cast<int>((tile / tiles_x) * kTileSize);
+      const int tile_max_x = static_cast<int>(
+          std::min(m_size.x, static_cast<unsigned>(tile_min_x) + kTileSize) -
+          1);
+      const int tile_max_y = static_cast<int>(
+          std::min(m_size.y, static_cast<unsigned>(tile_min_y) + kTileSize) -
+          1);
+      for (size_t i = tile_starts[tile]; i < tile_starts[tile + 1]; ++i) {
+        const TriangleSetup &setup = setups[bins[i]];
+        const int min_x = std::max(setup.m_min_x, tile_min_x);
+        const int max_x = std::min(setup.m_max_x, tile_max_x);
+        const int min_y = std::max(setup.m_min_y, tile_min_y);
+        const int max_y = std::min(setup.m_max_y, tile_max_y);
+        for (int y = min_y; y <= max_y; ++y) {
+          const size_t row = static_cast<size_t>(y) * m_size.x;
+#if SOFTWARE_RASTERIZER_X86
+          if (use_avx2) {
+            FillSpanAvx2(setup, y, min_x, max_x, &m_color[row],
+                         &m_depth[row], use_depth);
+            continue;
+          }
+#endif
+          FillSpanScalar(setup, y, min_x, max_x, &m_color[row], &m_depth[row],
+                         use_depth);
+        }
+      }
+    }
+  });
+}
+
+/////////////////////////////////////////////////
+void SoftwareRasterizer::SetSimdLevel(SimdLevel level) {
+  m_simd_level = level;
+}
+
+/////////////////////////////////////////////////
+sf::Vector2u SoftwareRasterizer::GetSize() const { return m_size; }
+
+/////////////////////////////////////////////////
+sf::Image SoftwareRasterizer::GetImage() const {
+  return sf::Image(m_size, reinterpret_cast<const std::uint8_t *>(
+                               m_color.data()));
+}
+
+/////////////////////////////////////////////////
+std::span<const float> SoftwareRasterizer::GetDepth() const {
+  return m_depth;
+}
+
+} // namespace projection_generator
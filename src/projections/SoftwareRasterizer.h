@@ -0,0 +1,109 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the SoftwareRasterizer class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ProjectionKernels.h"
+#include "ThreadPool.h"
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class SoftwareRasterizer
+/// @brief Render target that draws projected triangles on the CPU, so
+/// snapshots can be turned into images without a display or GPU context.
+///
+/// Triangles are set up and sorted into square tiles of the target, then
+/// the tiles are filled in parallel, each by one thread, so no two threads
+/// write the same pixel. Within a tile triangles are drawn in submission
+/// order, eight pixels of a row at a time with AVX2 where the CPU has it.
+/// Every level computes the same values, see ProjectionKernels.h.
+///
+/// A pixel is covered when its centre is inside a triangle. Centres exactly
+/// on an edge belong to only one of the two triangles sharing it, so meshes
+/// draw without gaps or pixels drawn twice. Vertex colors are interpolated
+/// across each triangle and written without blending.
+/////////////////////////////////////////////////
+class SoftwareRasterizer {
+private:
+  ThreadPool &m_thread_pool;
+
+  sf::Vector2u m_size;
+
+  SimdLevel m_simd_level{GetSupportedSimdLevel()};
+
+  /////////////////////////////////////////////////
+  /// @brief Pixels in sf::Image's RGBA byte order, row by row
+  /////////////////////////////////////////////////
+  std::vector<std::uint32_t> m_color;
+
+  /////////////////////////////////////////////////
+  /// @brief Depth of the nearest surface drawn at every pixel, larger being
+  /// nearer, -infinity where nothing has been drawn
+  /////////////////////////////////////////////////
+  std::vector<float> m_depth;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Constructor, the target starts out transparent
+  ///
+  /// @param size Width and height of the target in pixels
+  /// @param thread_pool Pool the tiles are filled on
+  /////////////////////////////////////////////////
+  explicit SoftwareRasterizer(
+      sf::Vector2u size, ThreadPool &thread_pool = ThreadPool::GetShared());
+
+  /////////////////////////////////////////////////
+  /// @brief Fill the target with a color and forget all depths
+  /////////////////////////////////////////////////
+  void Clear(sf::Color background = sf::Color::Transparent);
+
+  /////////////////////////////////////////////////
+  /// @brief Draw a triangle list, such as Projector::GetShape
+  ///
+  /// @param triangles Three vertices per triangle, in either winding
+  /// @param depth One depth per vertex (see Projector::SetKeepDepth), so
+  /// only the nearest surface at every pixel is kept. If empty, later
+  /// triangles cover earlier ones.
+  /// @param area Part of the plane the triangles lie in that maps onto the
+  /// whole target, like the rectangle of an sf::View
+  /////////////////////////////////////////////////
+  void Draw(std::span<const sf::Vertex> triangles,
+            std::span<const float> depth, const sf::FloatRect &area);
+
+  /////////////////////////////////////////////////
+  /// @brief Fill spans with a lower instruction set than the CPU supports,
+  /// which gives the same pixels. Only AVX2 has a vector version, other
+  /// levels use the scalar one.
+  /////////////////////////////////////////////////
+  void SetSimdLevel(SimdLevel level);
+
+  sf::Vector2u GetSize() const;
+
+  /////////////////////////////////////////////////
+  /// @brief Copy of the color buffer
+  /////////////////////////////////////////////////
+  sf::Image GetImage() const;
+
+  /////////////////////////////////////////////////
+  /// @brief The depth buffer, row by row, see m_depth
+  /////////////////////////////////////////////////
+  std::span<const float> GetDepth() const;
+};
+} // namespace projection_generator
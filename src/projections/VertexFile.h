@@ -0,0 +1,314 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Layout of vertex files and the header-only VertexFileReader
+///
+/// A vertex file holds the projected snapshots of a sweep, written by
+/// SnapshotWriter. It is laid out so a reader can map it and use the arrays
+/// in place:
+///
+/// - a VertexFileHeader at offset 0
+/// - per snapshot, the x of every vertex, their y, their colors and, if
+///   kept, their depths, each array starting on a kVertexFileAlignment
+///   boundary and zero padded to the next one
+/// - the table of VertexFileEntry, one per snapshot in sweep order, at
+///   VertexFileHeader::m_table_offset
+///
+/// Vertices come three per triangle. Every number is stored in the byte
+/// order of the writer, which readers check against m_byte_order.
+///
+/// This header only needs the standard library and POSIX, so it can be
+/// copied into programs that load the files without the rest of the tool.
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+namespace projection_generator {
+
+constexpr std::array<char, 8> kVertexFileMagic{'P', 'G', 'V', 'E',
+                                               'R', 'T', 'E', 'X'};
+
+/////////////////////////////////////////////////
+/// @brief Bump whenever the layout changes
+/////////////////////////////////////////////////
+constexpr std::uint32_t kVertexFileVersion = 1;
+
+/////////////////////////////////////////////////
+/// @brief Every array starts on this boundary, enough for any vector load
+/////////////////////////////////////////////////
+constexpr std::uint64_t kVertexFileAlignment = 64;
+
+/////////////////////////////////////////////////
+/// @brief Reads back as 0x01020304 in the byte order of the writer
+/////////////////////////////////////////////////
+constexpr std::uint32_t kVertexFileByteOrder = 0x01020304;
+
+/////////////////////////////////////////////////
+/// @brief Vertex color, in the byte order of sf::Color
+/////////////////////////////////////////////////
+struct VertexFileColor {
+  std::uint8_t r;
+  std::uint8_t g;
+  std::uint8_t b;
+  std::uint8_t a;
+};
+
+/////////////////////////////////////////////////
+/// @brief Fixed header at the start of every vertex file
+/////////////////////////////////////////////////
+struct VertexFileHeader {
+  std::array<char, 8> m_magic;
+  std::uint32_t m_version;
+  std::uint32_t m_byte_order;
+  std::uint64_t m_num_snapshots;
+  std::uint64_t m_table_offset;
+  std::uint64_t m_file_size;
+  std::array<std::uint64_t, 3> m_reserved;
+};
+
+/////////////////////////////////////////////////
+/// @brief Where one snapshot's arrays are, offsets being from the start of
+/// the file
+/////////////////////////////////////////////////
+struct VertexFileEntry {
+  /////////////////////////////////////////////////
+  /// @brief Step of the sweep, see Snapshot::m_index
+  /////////////////////////////////////////////////
+  std::uint64_t m_index;
+  std::uint64_t m_num_vertices;
+  std::uint64_t m_x_offset;
+  std::uint64_t m_y_offset;
+  std::uint64_t m_color_offset;
+
+  /////////////////////////////////////////////////
+  /// @brief 0 if the snapshot has no depths
+  /////////////////////////////////////////////////
+  std::uint64_t m_depth_offset;
+
+  /////////////////////////////////////////////////
+  /// @brief Bounds of the positions, all 0 for an empty snapshot
+  /////////////////////////////////////////////////
+  float m_min_x;
+  float m_min_y;
+  float m_max_x;
+  float m_max_y;
+};
+
+static_assert(std::is_trivially_copyable_v<VertexFileHeader>);
+static_assert(std::is_trivially_copyable_v<VertexFileEntry>);
+static_assert(sizeof(VertexFileHeader) == 64);
+static_assert(sizeof(VertexFileEntry) == 64);
+static_assert(sizeof(VertexFileColor) == 4);
+
+/////////////////////////////////////////////////
+/// @class VertexFileMapping
+/// @brief Read-only memory mapping of a whole file, for the readers of
+/// vertex files. Views into it must not outlive it.
+/////////////////////////////////////////////////
+class VertexFileMapping {
+private:
+  const std::byte *m_data{nullptr};
+
+  std::size_t m_size{0};
+
+  void Release() {
+    if (m_data != nullptr)
+      ::munmap(const_cast<std::byte *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+  }
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Map a file, throws std::runtime_error if it cannot be opened or
+  /// mapped
+  /////////////////////////////////////////////////
+  explicit VertexFileMapping(const std::filesystem::path &file_path) {
+    const int file_descriptor = ::open(file_path.c_str(), O_RDONLY);
+    if (file_descriptor < 0) {
+      throw std::runtime_error("Could not open file for mapping: " +
+                               file_path.string());
+    }
+    struct stat file_stat {};
+    if (::fstat(file_descriptor, &file_stat) != 0) {
+      ::close(file_descriptor);
+      throw std::runtime_error("Could not stat file: " + file_path.string());
+    }
+    m_size = static_cast<std::size_t>(file_stat.st_size);
+    if (m_size > 0) {
+      void *mapping =
+          ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+      if (mapping == MAP_FAILED) {
+        ::close(file_descriptor);
+        throw std::runtime_error("Could not map file: " + file_path.string());
+      }
+      m_data = static_cast<const std::byte *>(mapping);
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(file_descriptor);
+  }
+
+  ~VertexFileMapping() { Release(); }
+
+  VertexFileMapping(const VertexFileMapping &) = delete;
+  VertexFileMapping &operator=(const VertexFileMapping &) = delete;
+
+  VertexFileMapping(VertexFileMapping &&other) noexcept
+      : m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)) {}
+
+  VertexFileMapping &operator=(VertexFileMapping &&other) noexcept {
+    if (this != &other) {
+      Release();
+      m_data = std::exchange(other.m_data, nullptr);
+      m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+  }
+
+  const std::byte *GetData() const { return m_data; }
+
+  std::size_t GetSize() const { return m_size; }
+
+  /////////////////////////////////////////////////
+  /// @brief View count values of type T at offset, which the caller has
+  /// checked to be inside the file
+  /////////////////////////////////////////////////
+  template <typename T>
+  std::span<const T> GetArray(std::uint64_t offset,
+                              std::uint64_t count) const {
+    return {reinterpret_cast<const T *>(m_data + offset),
+            static_cast<std::size_t>(count)};
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Whether count values of the given size fit at offset
+  /////////////////////////////////////////////////
+  bool IsInFile(std::uint64_t offset, std::uint64_t count,
+                std::uint64_t value_size) const {
+    return offset <= m_size && count <= (m_size - offset) / value_size;
+  }
+};
+
+/////////////////////////////////////////////////
+/// @class VertexFileReader
+/// @brief Read-only mapping of a vertex file. The header and table are
+/// checked once when the file is opened; after that every accessor is a
+/// pointer into the mapping, so nothing is parsed or copied. Spans must not
+/// outlive the reader.
+/////////////////////////////////////////////////
+class VertexFileReader {
+private:
+  VertexFileMapping m_mapping;
+
+  std::span<const VertexFileEntry> m_entries;
+
+  /////////////////////////////////////////////////
+  /// @brief Whether count values of the given size fit at offset, which has
+  /// to be aligned
+  /////////////////////////////////////////////////
+  bool IsArrayInFile(std::uint64_t offset, std::uint64_t count,
+                     std::uint64_t value_size) const {
+    return offset % kVertexFileAlignment == 0 &&
+           m_mapping.IsInFile(offset, count, value_size);
+  }
+
+  void Validate(const std::filesystem::path &file_path) {
+    auto fail = [&](const char *reason) {
+      throw std::runtime_error(std::string(reason) + ": " +
+                               file_path.string());
+    };
+    if (m_mapping.GetSize() < sizeof(VertexFileHeader))
+      fail("Vertex file is too short");
+
+    const VertexFileHeader &header =
+        m_mapping.GetArray<VertexFileHeader>(0, 1)[0];
+    if (header.m_magic != kVertexFileMagic)
+      fail("Not a vertex file or not closed by its writer");
+    if (header.m_version != kVertexFileVersion)
+      fail("Unsupported vertex file version");
+    if (header.m_byte_order != kVertexFileByteOrder)
+      fail("Vertex file was written with another byte order");
+    if (header.m_file_size != m_mapping.GetSize())
+      fail("Vertex file is truncated");
+    if (!IsArrayInFile(header.m_table_offset, header.m_num_snapshots,
+                       sizeof(VertexFileEntry)))
+      fail("Vertex file table runs past end of file");
+
+    m_entries = m_mapping.GetArray<VertexFileEntry>(header.m_table_offset,
+                                                    header.m_num_snapshots);
+    for (const VertexFileEntry &entry : m_entries) {
+      const std::uint64_t count = entry.m_num_vertices;
+      if (!IsArrayInFile(entry.m_x_offset, count, sizeof(float)) ||
+          !IsArrayInFile(entry.m_y_offset, count, sizeof(float)) ||
+          !IsArrayInFile(entry.m_color_offset, count,
+                         sizeof(VertexFileColor)) ||
+          (entry.m_depth_offset != 0 &&
+           !IsArrayInFile(entry.m_depth_offset, count, sizeof(float))))
+        fail("Vertex file snapshot runs past end of file");
+    }
+  }
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Map a vertex file, throws std::runtime_error if it cannot be
+  /// mapped or is not a complete vertex file of this version
+  /////////////////////////////////////////////////
+  explicit VertexFileReader(const std::filesystem::path &file_path)
+      : m_mapping(file_path) {
+    Validate(file_path);
+  }
+
+  std::size_t GetSnapshotCount() const { return m_entries.size(); }
+
+  const VertexFileEntry &GetEntry(std::size_t snapshot) const {
+    return m_entries[snapshot];
+  }
+
+  std::span<const float> GetX(std::size_t snapshot) const {
+    const VertexFileEntry &entry = m_entries[snapshot];
+    return m_mapping.GetArray<float>(entry.m_x_offset, entry.m_num_vertices);
+  }
+
+  std::span<const float> GetY(std::size_t snapshot) const {
+    const VertexFileEntry &entry = m_entries[snapshot];
+    return m_mapping.GetArray<float>(entry.m_y_offset, entry.m_num_vertices);
+  }
+
+  std::span<const VertexFileColor> GetColors(std::size_t snapshot) const {
+    const VertexFileEntry &entry = m_entries[snapshot];
+    return m_mapping.GetArray<VertexFileColor>(entry.m_color_offset,
+                                               entry.m_num_vertices);
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief One depth per vertex, empty if the snapshot has none
+  /////////////////////////////////////////////////
+  std::span<const float> GetDepth(std::size_t snapshot) const {
+    const VertexFileEntry &entry = m_entries[snapshot];
+    if (entry.m_depth_offset == 0)
+      return {};
+    return m_mapping.GetArray<float>(entry.m_depth_offset,
+                                     entry.m_num_vertices);
+  }
+};
+} // namespace projection_generator
@@ -0,0 +1,318 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the VisibilityIndex class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "VisibilityIndex.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <limits>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Triangles handed to one task
+/////////////////////////////////////////////////
+constexpr size_t kIntervalGrain = 1 << 14;
+
+/////////////////////////////////////////////////
+/// @brief Facing terms within this of kMinFacing are left to the exact
+/// test. Unit normals and rotations keep the rounding error of both the
+/// analytic and the exact term around 1e-6.
+/////////////////////////////////////////////////
+constexpr double kFacingMargin = 1e-4;
+
+/////////////////////////////////////////////////
+/// @brief Run of snapshot indices, cyclic modulo the snapshot count
+/////////////////////////////////////////////////
+struct SnapshotRange {
+  std::int64_t m_first{0};
+
+  std::int64_t m_count{0};
+};
+
+/////////////////////////////////////////////////
+/// @brief Snapshots where one triangle certainly faces the view, and the up
+/// to two runs either side of them where it has to be tested
+/////////////////////////////////////////////////
+struct TriangleArcs {
+  SnapshotRange m_facing;
+
+  std::array<SnapshotRange, 2> m_boundary;
+};
+
+/////////////////////////////////////////////////
+/// @brief Inclusive snapshot indices i with R cos(theta_i - phi) > threshold
+/// (or >= when inclusive is set), as [first, last], empty if last < first
+///
+/// @param centre phi in snapshot units
+/// @param amplitude R, not negative
+/// @param step Angle between snapshots
+/////////////////////////////////////////////////
+std::pair<std::int64_t, std::int64_t>
+GetArc(double centre, double amplitude, double threshold, double step,
+       std::int64_t num_snapshots, bool inclusive) {
+  if (amplitude <= 0.0 || threshold / amplitude < -1.0) {
+    if (threshold < 0.0 || (inclusive && threshold == 0.0))
+      return {0, num_snapshots - 1};
+    return {0, -1};
+  }
+  const double ratio = threshold / amplitude;
+  if (ratio >= 1.0)
+    return {0, -1};
+  const double half_width = std::acos(ratio) / step;
+  if (inclusive) {
+    return {static_cast<std::int64_t>(std::ceil(centre - half_width)),
+            static_cast<std::int64_t>(std::floor(centre + half_width))};
+  }
+  return {static_cast<std::int64_t>(std::floor(centre - half_width)) + 1,
+          static_cast<std::int64_t>(std::ceil(centre + half_width)) - 1};
+}
+
+/////////////////////////////////////////////////
+TriangleArcs GetTriangleArcs(const glm::vec3 &normal, const glm::mat3 &tilt,
+                             const glm::vec3 &axis, double step,
+                             std::int64_t num_snapshots) {
+  TriangleArcs arcs;
+  if (normal == glm::vec3(0.0f))
+    return arcs; // no area, never drawn
+
+  // e_z . R(theta) v by Rodrigues' formula, with v the tilted normal
+  const glm::vec3 v = tilt * normal;
+  const double along_axis = glm::dot(axis, v);
+  const double a = v.z - axis.z * along_axis;
+  const double b = glm::cross(axis, v).z;
+  const double c = axis.z * along_axis;
+  const double amplitude = std::hypot(a, b);
+  const double centre = std::atan2(b, a) / step;
+
+  auto [first, last] = GetArc(centre, amplitude, kMinFacing + kFacingMargin - c,
+                              step, num_snapshots, false);
+  auto [outer_first, outer_last] =
+      GetArc(centre, amplitude, kMinFacing - kFacingMargin - c, step,
+             num_snapshots, true);
+  const std::int64_t count = std::max<std::int64_t>(0, last - first + 1);
+  if (count >= num_snapshots) {
+    arcs.m_facing = {0, num_snapshots};
+    return arcs;
+  }
+  if (count == 0) {
+    const std::int64_t outer_count =
+        std::max<std::int64_t>(0, outer_last - outer_first + 1);
+    arcs.m_boundary[0] = {outer_first, std::min(outer_count, num_snapshots)};
+    return arcs;
+  }
+
+  arcs.m_facing = {first, count};
+  if (outer_last - outer_first + 1 >= num_snapshots) {
+    arcs.m_boundary[0] = {last + 1, num_snapshots - count};
+    return arcs;
+  }
+  arcs.m_boundary[0] = {outer_first, first - outer_first};
+  arcs.m_boundary[1] = {last + 1, outer_last - last};
+  return arcs;
+}
+
+/////////////////////////////////////////////////
+std::uint32_t Wrap(std::int64_t index, std::int64_t num_snapshots) {
+  return static_cast<std::uint32_t>(
+      ((index % num_snapshots) + num_snapshots) % num_snapshots);
+}
+
+/////////////////////////////////////////////////
+/// @brief Marks a missing enter or leave event
+/////////////////////////////////////////////////
+constexpr std::uint32_t kNoSnapshot = std::numeric_limits<std::uint32_t>::max();
+
+/////////////////////////////////////////////////
+/// @brief TriangleArcs reduced to what the per snapshot lists need, with
+/// every snapshot index already wrapped
+/////////////////////////////////////////////////
+struct TriangleEvents {
+  std::uint32_t m_enter{kNoSnapshot};
+
+  std::uint32_t m_leave{kNoSnapshot};
+
+  std::array<std::uint32_t, 2> m_boundary_first{0, 0};
+
+  std::array<std::uint32_t, 2> m_boundary_count{0, 0};
+
+  bool m_initially_facing{false};
+};
+
+/////////////////////////////////////////////////
+TriangleEvents GetTriangleEvents(const TriangleArcs &arcs,
+                                 std::int64_t num_snapshots) {
+  TriangleEvents events;
+  const SnapshotRange &facing = arcs.m_facing;
+  if (facing.m_count == num_snapshots) {
+    events.m_initially_facing = true;
+  } else if (facing.m_count > 0) {
+    // a run that is neither empty nor full enters where it starts and leaves
+    // one past where it ends, except where that is snapshot 0, which the
+    // initial set covers
+    const std::uint32_t start = Wrap(facing.m_first, num_snapshots);
+    const std::uint32_t end =
+        Wrap(facing.m_first + facing.m_count, num_snapshots);
+    events.m_initially_facing =
+        start == 0 || start + facing.m_count > num_snapshots;
+    if (start != 0)
+      events.m_enter = start;
+    if (end != 0)
+      events.m_leave = end;
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    events.m_boundary_first[i] =
+        Wrap(arcs.m_boundary[i].m_first, num_snapshots);
+    events.m_boundary_count[i] =
+        static_cast<std::uint32_t>(arcs.m_boundary[i].m_count);
+  }
+  return events;
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+VisibilityIndex::VisibilityIndex(ThreadPool &thread_pool,
+                                 const Fragment3D &fragment,
+                                 const glm::mat3 &tilt,
+                                 const glm::vec3 &rotation_axis,
+                                 size_t num_snapshots)
+    : m_num_snapshots(num_snapshots),
+      m_num_triangles(fragment.GetTriangles().size()) {
+
+  if (m_num_triangles > std::numeric_limits<std::uint32_t>::max() ||
+      num_snapshots >= kNoSnapshot) {
+    throw std::runtime_error(
+        "Too many triangles or snapshots for a visibility index.");
+  }
+  m_initial.assign((m_num_triangles + 63) / 64, 0);
+  if (num_snapshots == 0) {
+    m_enter_offsets.assign(1, 0);
+    m_leave_offsets.assign(1, 0);
+    m_boundary_offsets.assign(1, 0);
+    return;
+  }
+
+  const auto snapshots = static_cast<std::int64_t>(num_snapshots);
+  const double step = 2.0 * std::numbers::pi / static_cast<double>(snapshots);
+  const glm::vec3 axis = glm::normalize(rotation_axis);
+  const TriangleNormals &normals = fragment.GetTriangleNormals();
+
+  std::vector<TriangleEvents> events(m_num_triangles);
+  thread_pool.ParallelFor(
+      0, m_num_triangles, kIntervalGrain, [&](size_t first, size_t last) {
+        // triangles are ordered by normal bin, so flat regions give
+        // long runs of equal normals that share one set of events
+        for (size_t t = first; t < last; ++t) {
+          if (t > first && normals[t] == normals[t - 1]) {
+            events[t] = events[t - 1];
+            continue;
+          }
+          events[t] = GetTriangleEvents(
+              GetTriangleArcs(normals[t], tilt, axis, step, snapshots),
+              snapshots);
+        }
+      });
+
+  // counting sort of the events into per snapshot lists, in triangle order
+  auto for_each_boundary = [&](const TriangleEvents &triangle, auto visit) {
+    for (size_t i = 0; i < 2; ++i) {
+      std::uint32_t snapshot = triangle.m_boundary_first[i];
+      for (std::uint32_t k = 0; k < triangle.m_boundary_count[i]; ++k) {
+        visit(snapshot);
+        if (++snapshot == num_snapshots)
+          snapshot = 0;
+      }
+    }
+  };
+
+  m_enter_offsets.assign(num_snapshots + 1, 0);
+  m_leave_offsets.assign(num_snapshots + 1, 0);
+  m_boundary_offsets.assign(num_snapshots + 1, 0);
+  for (size_t t = 0; t < m_num_triangles; ++t) {
+    const TriangleEvents &triangle = events[t];
+    if (triangle.m_initially_facing)
+      m_initial[t / 64] |= std::uint64_t{1} << (t % 64);
+    if (triangle.m_enter != kNoSnapshot)
+      ++m_enter_offsets[triangle.m_enter + 1];
+    if (triangle.m_leave != kNoSnapshot)
+      ++m_leave_offsets[triangle.m_leave + 1];
+    for_each_boundary(triangle, [&](std::uint32_t snapshot) {
+      ++m_boundary_offsets[snapshot + 1];
+    });
+  }
+  for (size_t s = 1; s <= num_snapshots; ++s) {
+    m_enter_offsets[s] += m_enter_offsets[s - 1];
+    m_leave_offsets[s] += m_leave_offsets[s - 1];
+    m_boundary_offsets[s] += m_boundary_offsets[s - 1];
+  }
+
+  m_enters.resize(m_enter_offsets.back());
+  m_leaves.resize(m_leave_offsets.back());
+  m_boundaries.resize(m_boundary_offsets.back());
+  std::vector<size_t> enter_cursors(m_enter_offsets.begin(),
+                                    m_enter_offsets.end() - 1);
+  std::vector<size_t> leave_cursors(m_leave_offsets.begin(),
+                                    m_leave_offsets.end() - 1);
+  std::vector<size_t> boundary_cursors(m_boundary_offsets.begin(),
+                                       m_boundary_offsets.end() - 1);
+  for (size_t t = 0; t < m_num_triangles; ++t) {
+    const TriangleEvents &triangle = events[t];
+    const auto id = static_cast<std::uint32_t>(t);
+    if (triangle.m_enter != kNoSnapshot)
+      m_enters[enter_cursors[triangle.m_enter]++] = id;
+    if (triangle.m_leave != kNoSnapshot)
+      m_leaves[leave_cursors[triangle.m_leave]++] = id;
+    for_each_boundary(triangle, [&](std::uint32_t snapshot) {
+      m_boundaries[boundary_cursors[snapshot]++] = id;
+    });
+  }
+}
+
+/////////////////////////////////////////////////
+void VisibilityIndex::Advance(size_t snapshot,
+                              std::vector<std::uint64_t> &facing) const {
+  if (snapshot == 0) {
+    facing = m_initial;
+    return;
+  }
+  for (size_t i = m_leave_offsets[snapshot]; i < m_leave_offsets[snapshot + 1];
+       ++i) {
+    const std::uint32_t t = m_leaves[i];
+    facing[t / 64] &= ~(std::uint64_t{1} << (t % 64));
+  }
+  for (size_t i = m_enter_offsets[snapshot]; i < m_enter_offsets[snapshot + 1];
+       ++i) {
+    const std::uint32_t t = m_enters[i];
+    facing[t / 64] |= std::uint64_t{1} << (t % 64);
+  }
+}
+
+/////////////////////////////////////////////////
+void VisibilityIndex::Seek(size_t snapshot,
+                           std::vector<std::uint64_t> &facing) const {
+  facing = m_initial;
+  for (size_t s = 1; s <= snapshot; ++s)
+    Advance(s, facing);
+}
+
+/////////////////////////////////////////////////
+std::span<const std::uint32_t>
+VisibilityIndex::GetBoundaryTriangles(size_t snapshot) const {
+  return std::span(m_boundaries)
+      .subspan(m_boundary_offsets[snapshot],
+               m_boundary_offsets[snapshot + 1] - m_boundary_offsets[snapshot]);
+}
+
+} // namespace projection_generator
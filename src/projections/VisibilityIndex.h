@@ -0,0 +1,111 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the VisibilityIndex class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "Fragment3D.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat3x3.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class VisibilityIndex
+/// @brief Which triangles face the view at each step of a rotation sweep,
+/// stored as the changes between steps.
+///
+/// For a view rotated by theta about a fixed axis after a fixed tilt, the
+/// facing term dot(view, normal) of a triangle is A cos(theta) +
+/// B sin(theta) + C, so every triangle faces the view over one arc of the
+/// circle (possibly empty or all of it). The arcs are turned into snapshot
+/// index ranges and their endpoints counting sorted into per snapshot enter
+/// and leave lists, so a sweep only touches triangles whose facing changes.
+///
+/// Near an arc endpoint the facing term is close to kMinFacing and the
+/// analytic result could disagree with the per triangle test through
+/// rounding, so snapshots within a small margin of an endpoint list the
+/// triangle as a boundary triangle instead, to be tested exactly by the
+/// caller.
+/////////////////////////////////////////////////
+class VisibilityIndex {
+private:
+  size_t m_num_snapshots{0};
+
+  size_t m_num_triangles{0};
+
+  /////////////////////////////////////////////////
+  /// @brief Triangles certainly facing the view at snapshot 0, one bit each
+  /////////////////////////////////////////////////
+  std::vector<std::uint64_t> m_initial;
+
+  /////////////////////////////////////////////////
+  /// @brief Snapshot s starts showing m_enters[m_enter_offsets[s],
+  /// m_enter_offsets[s + 1]), likewise for the other two lists
+  /////////////////////////////////////////////////
+  std::vector<size_t> m_enter_offsets;
+
+  std::vector<std::uint32_t> m_enters;
+
+  std::vector<size_t> m_leave_offsets;
+
+  std::vector<std::uint32_t> m_leaves;
+
+  std::vector<size_t> m_boundary_offsets;
+
+  std::vector<std::uint32_t> m_boundaries;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Build the index for snapshots at angles 2 pi s / num_snapshots,
+  /// throws std::runtime_error if there are 2^32 triangles or snapshots or
+  /// more
+  ///
+  /// @param thread_pool Pool used to compute the arcs in parallel
+  /// @param fragment Fragment whose triangle normals are swept
+  /// @param tilt Rotation applied before the swept rotation
+  /// @param rotation_axis Axis of the swept rotation
+  /// @param num_snapshots Number of evenly spaced angles
+  /////////////////////////////////////////////////
+  VisibilityIndex(ThreadPool &thread_pool, const Fragment3D &fragment,
+                  const glm::mat3 &tilt, const glm::vec3 &rotation_axis,
+                  size_t num_snapshots);
+
+  /////////////////////////////////////////////////
+  /// @brief Update a bit set of certainly facing triangles from snapshot
+  /// - 1 to snapshot; snapshot 0 resets it. Snapshots must be visited in
+  /// order.
+  ///
+  /// @param snapshot Snapshot to move to
+  /// @param facing One bit per triangle, sized by the call for snapshot 0
+  /////////////////////////////////////////////////
+  void Advance(size_t snapshot, std::vector<std::uint64_t> &facing) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Set facing to the bit set of snapshot directly, by replaying
+  /// the changes since snapshot 0, so a sweep can be split into independent
+  /// runs of snapshots. Advance carries on from there.
+  ///
+  /// @param snapshot Snapshot to move to
+  /// @param facing One bit per triangle, resized by the call
+  /////////////////////////////////////////////////
+  void Seek(size_t snapshot, std::vector<std::uint64_t> &facing) const;
+
+  /////////////////////////////////////////////////
+  /// @brief Triangles whose facing at snapshot has to be tested exactly
+  /////////////////////////////////////////////////
+  std::span<const std::uint32_t> GetBoundaryTriangles(size_t snapshot) const;
+};
+} // namespace projection_generator
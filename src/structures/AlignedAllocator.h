@@ -0,0 +1,68 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the AlignedAllocator class template.
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief Cache line size, used as the default alignment for bulk buffers
+/////////////////////////////////////////////////
+inline constexpr std::size_t kCacheLineSize = 64;
+
+/////////////////////////////////////////////////
+/// @class AlignedAllocator
+/// @brief Standard allocator handing out storage aligned to Alignment bytes,
+/// so the first element of a buffer starts on a cache line and vector loads
+/// from it never split one
+/////////////////////////////////////////////////
+template <typename T, std::size_t Alignment = kCacheLineSize>
+class AlignedAllocator {
+  static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two no smaller than alignof(T)");
+
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  T *allocate(std::size_t count) {
+    return static_cast<T *>(
+        ::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T *pointer, std::size_t) noexcept {
+    ::operator delete(pointer, std::align_val_t{Alignment});
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return true;
+  }
+};
+
+/////////////////////////////////////////////////
+/// @brief std::vector whose storage starts on a cache line
+/////////////////////////////////////////////////
+template <typename T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+} // namespace projection_generator
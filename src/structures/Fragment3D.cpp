@@ -8,25 +8,214 @@
 /// Headers
 /////////////////////////////////////////////////
 #include "Fragment3D.h"
+#include "GreedyMesher.h"
+#include "InteriorFaceRemover.h"
+#include "ThreadPool.h"
+#include "Triangulator.h"
 #include "glm/ext/vector_float3.hpp"
 #include "happly.h"
 #include <SFML/System/Vector3.hpp>
 #include <array>
+#include <bit>
+#include <cstdint>
 #include <cwchar>
 #include <iostream> // For debug messages
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace projection_generator {
 
-Fragment3D::Fragment3D(happly::PLYData &data) {
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Below this many vertices welding runs on the calling thread
+/////////////////////////////////////////////////
+constexpr size_t kMinParallelWeldVertices = 1 << 16;
+
+/////////////////////////////////////////////////
+/// @brief The parallel weld splits the vertices into 2^kWeldShardBits
+/// independent hash tables
+/////////////////////////////////////////////////
+constexpr int kWeldShardBits = 6;
+
+/////////////////////////////////////////////////
+/// @brief Vertices or faces handed to one task in the parallel weld passes
+/////////////////////////////////////////////////
+constexpr size_t kWeldGrain = 1 << 14;
+
+/////////////////////////////////////////////////
+/// @brief Exact identity of a vertex for welding: the position bit patterns
+/// and the packed color
+/////////////////////////////////////////////////
+struct WeldKey {
+  std::array<std::uint32_t, 3> m_position_bits;
+  std::uint32_t m_color;
+
+  bool operator==(const WeldKey &) const = default;
+};
+
+/////////////////////////////////////////////////
+WeldKey MakeWeldKey(const Vertex3 &vertex) {
+  WeldKey key{};
+  for (int axis = 0; axis < 3; ++axis) {
+    // -0.0f and 0.0f are the same point
+    const float value =
+        vertex.m_position[axis] == 0.0f ? 0.0f : vertex.m_position[axis];
+    key.m_position_bits[axis] = std::bit_cast<std::uint32_t>(value);
+  }
+  key.m_color = vertex.m_color.toInteger();
+  return key;
+}
+
+/////////////////////////////////////////////////
+/// @brief 64 bit mix of a WeldKey; the top bits pick the shard, so they
+/// have to be as well distributed as the bottom ones
+/////////////////////////////////////////////////
+std::uint64_t HashWeldKey(const WeldKey &key) {
+  std::uint64_t hash = 0x9e3779b97f4a7c15ull;
+  auto mix = [&hash](std::uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+  };
+  mix((static_cast<std::uint64_t>(key.m_position_bits[0]) << 32) |
+      key.m_position_bits[1]);
+  mix((static_cast<std::uint64_t>(key.m_position_bits[2]) << 32) |
+      key.m_color);
+  return hash;
+}
+
+/////////////////////////////////////////////////
+struct WeldKeyHash {
+  size_t operator()(const WeldKey &key) const {
+    return static_cast<size_t>(HashWeldKey(key));
+  }
+};
+
+/////////////////////////////////////////////////
+/// @brief For every vertex, the index of the first vertex with the same key
+/////////////////////////////////////////////////
+std::vector<size_t>
+FindWeldRepresentatives(const std::vector<Vertex3> &vertices) {
+
+  std::vector<size_t> representatives(vertices.size());
+
+  if (vertices.size() < kMinParallelWeldVertices) {
+    std::unordered_map<WeldKey, size_t, WeldKeyHash> first_seen;
+    first_seen.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      representatives[i] =
+          first_seen.try_emplace(MakeWeldKey(vertices[i]), i).first->second;
+    }
+    return representatives;
+  }
+
+  ThreadPool &pool = ThreadPool::GetShared();
+  constexpr size_t kNumShards = size_t{1} << kWeldShardBits;
+
+  std::vector<std::uint64_t> hashes(vertices.size());
+  pool.ParallelFor(0, vertices.size(), kWeldGrain,
+                   [&](size_t begin, size_t end) {
+                     for (size_t i = begin; i < end; ++i)
+                       hashes[i] = HashWeldKey(MakeWeldKey(vertices[i]));
+                   });
+
+  // counting sort by shard, stable so every shard lists its vertices in
+  // ascending order and the first insert into a table is the first occurrence
+  std::vector<size_t> shard_offsets(kNumShards + 1, 0);
+  for (const std::uint64_t hash : hashes)
+    ++shard_offsets[(hash >> (64 - kWeldShardBits)) + 1];
+  for (size_t shard = 0; shard < kNumShards; ++shard)
+    shard_offsets[shard + 1] += shard_offsets[shard];
+
+  std::vector<size_t> shard_members(vertices.size());
+  std::vector<size_t> cursors(shard_offsets.begin(), shard_offsets.end() - 1);
+  for (size_t i = 0; i < vertices.size(); ++i)
+    shard_members[cursors[hashes[i] >> (64 - kWeldShardBits)]++] = i;
+
+  pool.ParallelFor(0, kNumShards, 1, [&](size_t begin, size_t end) {
+    for (size_t shard = begin; shard < end; ++shard) {
+      std::unordered_map<WeldKey, size_t, WeldKeyHash> first_seen;
+      first_seen.reserve(shard_offsets[shard + 1] - shard_offsets[shard]);
+      for (size_t slot = shard_offsets[shard]; slot < shard_offsets[shard + 1];
+           ++slot) {
+        const size_t i = shard_members[slot];
+        representatives[i] =
+            first_seen.try_emplace(MakeWeldKey(vertices[i]), i).first->second;
+      }
+    }
+  });
+
+  return representatives;
+}
+
+/////////////////////////////////////////////////
+/// @brief Throw std::runtime_error if any index in primitives is not below
+/// num_vertices
+/////////////////////////////////////////////////
+template <typename Primitives>
+void CheckIndices(const Primitives &primitives, size_t num_vertices) {
+  for (const auto &primitive : primitives) {
+    for (const auto index : primitive) {
+      if (index >= num_vertices) {
+        std::cerr << "[ERROR] Index " << index << " out of bounds for "
+                  << num_vertices << " vertices." << std::endl;
+        throw std::runtime_error("Fragment3D index out of bounds.");
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void CheckIndices(const PolygonList &polygons, size_t num_vertices) {
+  CheckIndices(std::array{std::span(polygons.GetIndices())}, num_vertices);
+}
+
+} // namespace
+
+Fragment3D::Fragment3D(happly::PLYData &data,
+                       const Fragment3DOptions &options) {
   std::cout << "[DEBUG] Fragment3D constructor called." << std::endl;
   // Configure the fragment from the PLY data
-  ConfigureFromPlyFile(data);
+  ConfigureFromPlyFile(data, options);
   std::cout << "[DEBUG] Fragment3D constructor finished." << std::endl;
 }
 
 /////////////////////////////////////////////////
-void Fragment3D::ConfigureFromPlyFile(happly::PLYData &data) {
+Fragment3D::Fragment3D(std::vector<Vertex3> vertices,
+                       std::vector<std::array<size_t, 4>> faces,
+                       const Fragment3DOptions &options) {
+
+  CheckIndices(faces, vertices.size());
+  Build(std::move(vertices), std::move(faces), options);
+}
+
+/////////////////////////////////////////////////
+Fragment3D::Fragment3D(std::vector<Vertex3> vertices, PolygonList polygons,
+                       const Fragment3DOptions &options) {
+
+  CheckIndices(polygons, vertices.size());
+  std::vector<std::array<size_t, 4>> faces =
+      Triangulator(ThreadPool::GetShared()).SplitPolygons(vertices, polygons);
+  Build(std::move(vertices), std::move(faces), options);
+}
+
+/////////////////////////////////////////////////
+Fragment3D::Fragment3D(VertexSoA vertices, IndexBuffer<4> faces,
+                       IndexBuffer<3> triangles)
+    : m_vertices(std::move(vertices)), m_faces(std::move(faces)),
+      m_triangles(std::move(triangles)) {
+
+  ValidateIndices();
+  ComputeTriangleNormals();
+}
+
+/////////////////////////////////////////////////
+void Fragment3D::ConfigureFromPlyFile(happly::PLYData &data,
+                                      const Fragment3DOptions &options) {
 
   std::cout << "[DEBUG] Configuring Fragment3D from PLY file..." << std::endl;
 
@@ -49,8 +238,8 @@ void Fragment3D::ConfigureFromPlyFile(happly::PLYData &data) {
               << std::endl;
   }
 
-  m_vertices.clear();
-  m_vertices.reserve(numVertices);
+  std::vector<Vertex3> vertices;
+  vertices.reserve(numVertices);
 
   // for each vertex, extract the position and color
   for (size_t i = 0; i < numVertices; ++i) {
@@ -65,7 +254,7 @@ void Fragment3D::ConfigureFromPlyFile(happly::PLYData &data) {
     sf::Color color(vertex_colors[i][0], vertex_colors[i][1],
                     vertex_colors[i][2]);
 
-    m_vertices.emplace_back(position, color);
+    vertices.emplace_back(position, color);
   }
 
   // get number of faces and resize m_faces
@@ -78,50 +267,171 @@ void Fragment3D::ConfigureFromPlyFile(happly::PLYData &data) {
               << std::endl;
   }
 
-  m_faces.clear();
-  m_faces.reserve(numFaces);
+  PolygonList polygons;
+  size_t num_indices = 0;
+  for (const auto &face : face_indices)
+    num_indices += face.size();
+  polygons.Reserve(face_indices.size(), num_indices);
+  for (const auto &face : face_indices)
+    polygons.Add(face);
+
+  CheckIndices(polygons, vertices.size());
+  std::vector<std::array<size_t, 4>> faces =
+      Triangulator(ThreadPool::GetShared()).SplitPolygons(vertices, polygons);
+  Build(std::move(vertices), std::move(faces), options);
+  std::cout << "[DEBUG] Finished configuring Fragment3D from PLY file."
+            << std::endl;
+}
+
+/////////////////////////////////////////////////
+void Fragment3D::Build(std::vector<Vertex3> vertices,
+                       std::vector<std::array<size_t, 4>> faces,
+                       const Fragment3DOptions &options) {
+  if (options.m_weld_vertices)
+    WeldVertices(vertices, faces);
+  if (options.m_remove_interior_faces) {
+    const size_t num_removed =
+        InteriorFaceRemover(ThreadPool::GetShared()).Remove(vertices, faces);
+    std::cout << "[DEBUG] Removed " << num_removed
+              << " coincident interior faces." << std::endl;
+  }
+  if (options.m_greedy_mesh)
+    GreedyMesher(ThreadPool::GetShared()).Merge(vertices, faces);
+  if (options.m_remove_interior_faces || options.m_greedy_mesh)
+    RemoveUnreferencedVertices(vertices, faces);
+  GenerateTriangles(vertices, faces);
+  m_vertices = VertexSoA(vertices);
+  m_faces = IndexBuffer<4>::Compact(faces, m_vertices.size());
+  std::cout << "[DEBUG] Using " << m_faces.GetIndexSize() * 8
+            << " bit indices for " << m_vertices.size() << " vertices."
+            << std::endl;
+  ComputeTriangleNormals();
+}
+
+/////////////////////////////////////////////////
+void Fragment3D::WeldVertices(std::vector<Vertex3> &vertices,
+                              std::vector<std::array<size_t, 4>> &faces) {
+
+  const std::vector<size_t> representatives =
+      FindWeldRepresentatives(vertices);
 
-  for (size_t i = 0; i < numFaces; ++i) {
-    // Ensure the face has exactly 4 vertices
-    if (face_indices[i].size() == 4) {
-      m_faces.push_back({face_indices[i][0], face_indices[i][1],
-                         face_indices[i][2], face_indices[i][3]});
+  // survivors are numbered in order of first occurrence
+  std::vector<size_t> remap(vertices.size());
+  size_t num_unique = 0;
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    if (representatives[i] == i) {
+      remap[i] = num_unique;
+      vertices[num_unique++] = vertices[i];
     } else {
-      // Handle cases where the face does not have exactly 4 vertices
-      std::cerr << "[ERROR] Face " << i
-                << " does not have exactly 4 vertices (has "
-                << face_indices[i].size() << ")" << std::endl;
-      throw std::runtime_error("Face does not have exactly 4 vertices.");
+      remap[i] = remap[representatives[i]];
     }
   }
 
-  // Generate triangles from faces
-  m_triangles.clear();
-  m_triangles.reserve(m_faces.size() * 2);
+  const size_t num_welded = vertices.size() - num_unique;
+  std::cout << "[DEBUG] Welded " << num_welded << " duplicate vertices, "
+            << num_unique << " remain." << std::endl;
+  if (num_welded == 0)
+    return;
 
-  for (size_t i = 0; i < m_faces.size(); ++i) {
-    const auto &face = m_faces[i];
-    // Double-check size for safety
-    if (face.size() != 4) {
-      std::cerr << "[ERROR] Stored face " << i << " does not have 4 vertices!"
-                << std::endl;
+  vertices.resize(num_unique);
+
+  ThreadPool::GetShared().ParallelFor(
+      0, faces.size(), kWeldGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          for (size_t &index : faces[i])
+            index = remap[index];
+        }
+      });
+}
+
+/////////////////////////////////////////////////
+void Fragment3D::RemoveUnreferencedVertices(
+    std::vector<Vertex3> &vertices, std::vector<std::array<size_t, 4>> &faces) {
+
+  constexpr size_t kUnreferenced = static_cast<size_t>(-1);
+  std::vector<size_t> remap(vertices.size(), kUnreferenced);
+  for (const auto &face : faces) {
+    for (const size_t index : face)
+      remap[index] = 0;
+  }
+
+  size_t num_kept = 0;
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    if (remap[i] == kUnreferenced)
       continue;
-    }
-    m_triangles.push_back({face[0], face[1], face[2]});
-    m_triangles.push_back({face[0], face[2], face[3]});
+    remap[i] = num_kept;
+    vertices[num_kept++] = vertices[i];
   }
-  std::cout << "[DEBUG] Finished configuring Fragment3D from PLY file."
-            << std::endl;
+  if (num_kept == vertices.size())
+    return;
+
+  std::cout << "[DEBUG] Removed " << vertices.size() - num_kept
+            << " unreferenced vertices." << std::endl;
+  vertices.resize(num_kept);
+  for (auto &face : faces) {
+    for (size_t &index : face)
+      index = remap[index];
+  }
+}
+
+/////////////////////////////////////////////////
+void Fragment3D::GenerateTriangles(
+    const std::vector<Vertex3> &vertices,
+    const std::vector<std::array<size_t, 4>> &faces) {
+  std::vector<std::array<size_t, 3>> triangles =
+      Triangulator(ThreadPool::GetShared()).Triangulate(vertices, faces);
+  NormalClusterer(ThreadPool::GetShared()).SortByNormal(vertices, triangles);
+  m_triangles = IndexBuffer<3>::Compact(triangles, vertices.size());
+}
+
+/////////////////////////////////////////////////
+void Fragment3D::ValidateIndices() const {
+  const size_t num_vertices = m_vertices.size();
+  m_faces.Visit(
+      [num_vertices](auto faces) { CheckIndices(faces, num_vertices); });
+  m_triangles.Visit([num_vertices](auto triangles) {
+    CheckIndices(triangles, num_vertices);
+  });
 }
 
 /////////////////////////////////////////////////
-const std::vector<Vertex3> &Fragment3D::GetVertices() const {
-  return m_vertices;
+void Fragment3D::ComputeTriangleNormals() {
+  NormalClusterer(ThreadPool::GetShared())
+      .ComputeNormals(m_vertices, m_triangles, m_triangle_normals);
+}
+
+/////////////////////////////////////////////////
+const VertexSoA &Fragment3D::GetVertices() const { return m_vertices; }
+
+/////////////////////////////////////////////////
+std::span<const float> Fragment3D::GetPositionsX() const {
+  return m_vertices.GetX();
 }
 
 /////////////////////////////////////////////////
-const std::vector<std::array<size_t, 3>> &Fragment3D::GetTriangles() const {
-  return m_triangles;
+std::span<const float> Fragment3D::GetPositionsY() const {
+  return m_vertices.GetY();
+}
+
+/////////////////////////////////////////////////
+std::span<const float> Fragment3D::GetPositionsZ() const {
+  return m_vertices.GetZ();
+}
+
+/////////////////////////////////////////////////
+std::span<const sf::Color> Fragment3D::GetColors() const {
+  return m_vertices.GetColors();
+}
+
+/////////////////////////////////////////////////
+const IndexBuffer<4> &Fragment3D::GetFaces() const { return m_faces; }
+
+/////////////////////////////////////////////////
+const IndexBuffer<3> &Fragment3D::GetTriangles() const { return m_triangles; }
+
+/////////////////////////////////////////////////
+const TriangleNormals &Fragment3D::GetTriangleNormals() const {
+  return m_triangle_normals;
 }
 
 } // namespace projection_generator
@@ -11,9 +11,15 @@
 /////////////////////////////////////////////////
 /// Headers
 /////////////////////////////////////////////////
+#include "Fragment3DOptions.h"
+#include "IndexBuffer.h"
+#include "NormalClusterer.h"
+#include "PolygonList.h"
 #include "Vertex3.h"
+#include "VertexSoA.h"
 #include "happly.h"
 #include <array>
+#include <span>
 #include <vector>
 namespace projection_generator {
 
@@ -25,32 +31,133 @@ namespace projection_generator {
 class Fragment3D {
 private:
   /////////////////////////////////////////////////
-  /// @brief All vertex information provided by the object file (.ply e.t.c)
+  /// @brief All vertex information provided by the object file (.ply e.t.c),
+  /// stored one component array at a time
   /////////////////////////////////////////////////
-  std::vector<Vertex3> m_vertices;
+  VertexSoA m_vertices;
 
   /////////////////////////////////////////////////
-  /// @brief For storing the faces provided by the object file (.ply e.t.c)
+  /// @brief For storing the faces provided by the object file (.ply e.t.c).
+  /// A face whose last two indices are equal is a triangle.
   /////////////////////////////////////////////////
-  std::vector<std::array<size_t, 4>> m_faces;
+  IndexBuffer<4> m_faces;
 
   /////////////////////////////////////////////////
-  /// @brief storage of the triangles that are generated from the faces
+  /// @brief storage of the triangles that are generated from the faces, at
+  /// the same index width as m_faces
   /////////////////////////////////////////////////
-  std::vector<std::array<size_t, 3>> m_triangles;
+  IndexBuffer<3> m_triangles;
 
-  void ConfigureFromPlyFile(happly::PLYData &data);
+  /////////////////////////////////////////////////
+  /// @brief Unit normal of every triangle, zero for triangles with no area
+  /////////////////////////////////////////////////
+  TriangleNormals m_triangle_normals;
+
+  void ConfigureFromPlyFile(happly::PLYData &data,
+                            const Fragment3DOptions &options);
+
+  /////////////////////////////////////////////////
+  /// @brief Run the construction time processing on freshly loaded vertices
+  /// and faces, store both at their compact width and generate the triangles
+  /////////////////////////////////////////////////
+  void Build(std::vector<Vertex3> vertices,
+             std::vector<std::array<size_t, 4>> faces,
+             const Fragment3DOptions &options);
+
+  /////////////////////////////////////////////////
+  /// @brief Collapse vertices with identical position and color into one and
+  /// rewrite faces to the shared indices. Survivors keep the order of their
+  /// first occurrence, so the result does not depend on the thread count.
+  /////////////////////////////////////////////////
+  void WeldVertices(std::vector<Vertex3> &vertices,
+                    std::vector<std::array<size_t, 4>> &faces);
+
+  /////////////////////////////////////////////////
+  /// @brief Drop vertices no face refers to, keeping the order of the rest
+  /////////////////////////////////////////////////
+  void RemoveUnreferencedVertices(std::vector<Vertex3> &vertices,
+                                  std::vector<std::array<size_t, 4>> &faces);
+
+  /////////////////////////////////////////////////
+  /// @brief Fill m_triangles from the final faces, see
+  /// Triangulator::Triangulate, ordered so triangles facing the same way are
+  /// adjacent
+  /////////////////////////////////////////////////
+  void GenerateTriangles(const std::vector<Vertex3> &vertices,
+                         const std::vector<std::array<size_t, 4>> &faces);
+
+  /////////////////////////////////////////////////
+  /// @brief Throw std::runtime_error if any face or triangle indexes past the
+  /// end of m_vertices
+  /////////////////////////////////////////////////
+  void ValidateIndices() const;
+
+  /////////////////////////////////////////////////
+  /// @brief Fill m_triangle_normals from m_vertices and m_triangles
+  /////////////////////////////////////////////////
+  void ComputeTriangleNormals();
 
 public:
   /////////////////////////////////////////////////
   /// @brief Constructor taking a PLYData object
   ///
   /// @param data [TODO:parameter]
+  /// @param options Construction time processing to run
   /////////////////////////////////////////////////
-  Fragment3D(happly::PLYData &data);
+  Fragment3D(happly::PLYData &data, const Fragment3DOptions &options = {});
+
+  /////////////////////////////////////////////////
+  /// @brief Constructor taking vertex and face buffers that a loader has
+  /// already filled, so no intermediate PLYData is needed
+  ///
+  /// @param vertices Vertex positions and colors
+  /// @param faces Quads indexing into vertices
+  /// @param options Construction time processing to run
+  /////////////////////////////////////////////////
+  Fragment3D(std::vector<Vertex3> vertices,
+             std::vector<std::array<size_t, 4>> faces,
+             const Fragment3DOptions &options = {});
+
+  /////////////////////////////////////////////////
+  /// @brief Constructor taking polygons of any size. Triangles and quads
+  /// become faces as they are, larger polygons are triangulated first.
+  ///
+  /// @param vertices Vertex positions and colors
+  /// @param polygons Polygons indexing into vertices
+  /// @param options Construction time processing to run
+  /////////////////////////////////////////////////
+  Fragment3D(std::vector<Vertex3> vertices, PolygonList polygons,
+             const Fragment3DOptions &options = {});
+
+  /////////////////////////////////////////////////
+  /// @brief Constructor restoring a fragment that was fully built before
+  /// (e.g. read back from the mesh cache), so triangles are not regenerated
+  ///
+  /// @param vertices Vertex positions and colors
+  /// @param faces Quads indexing into vertices
+  /// @param triangles Triangles indexing into vertices
+  /////////////////////////////////////////////////
+  Fragment3D(VertexSoA vertices, IndexBuffer<4> faces,
+             IndexBuffer<3> triangles);
+
+  /////////////////////////////////////////////////
+  /// @brief Compatibility view of the vertices, indexing and iteration yield
+  /// Vertex3 values. Bulk loops should use the component spans below.
+  /////////////////////////////////////////////////
+  const VertexSoA &GetVertices() const;
+
+  std::span<const float> GetPositionsX() const;
+
+  std::span<const float> GetPositionsY() const;
+
+  std::span<const float> GetPositionsZ() const;
+
+  std::span<const sf::Color> GetColors() const;
+
+  const IndexBuffer<4> &GetFaces() const;
 
-  const std::vector<Vertex3> &GetVertices() const;
+  const IndexBuffer<3> &GetTriangles() const;
 
-  const std::vector<std::array<size_t, 3>> &GetTriangles() const;
+  const TriangleNormals &GetTriangleNormals() const;
 };
 } // namespace projection_generator
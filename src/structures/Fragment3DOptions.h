@@ -0,0 +1,41 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the Fragment3DOptions struct.
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @struct Fragment3DOptions
+/// @brief Switches for the processing a Fragment3D runs when it is built
+/// from loader buffers
+/////////////////////////////////////////////////
+struct Fragment3DOptions {
+  /////////////////////////////////////////////////
+  /// @brief Merge vertices with identical position and color and point the
+  /// faces at the shared copy
+  /////////////////////////////////////////////////
+  bool m_weld_vertices{true};
+
+  /////////////////////////////////////////////////
+  /// @brief Drop pairs of coincident, opposite facing faces such as the
+  /// walls between touching voxels, see InteriorFaceRemover. Off by default
+  /// as colors are not compared, so it would also delete intentionally
+  /// double-sided cards.
+  /////////////////////////////////////////////////
+  bool m_remove_interior_faces{false};
+
+  /////////////////////////////////////////////////
+  /// @brief Merge adjacent coplanar quads of one color into larger
+  /// rectangles, see GreedyMesher. Off by default as it changes the face
+  /// layout the source file describes.
+  /////////////////////////////////////////////////
+  bool m_greedy_mesh{false};
+};
+
+} // namespace projection_generator
@@ -0,0 +1,334 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the GreedyMesher class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "GreedyMesher.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Groups whose grid would have more than this many cells per quad
+/// (quads scattered thinly over a large plane) are left unmerged rather than
+/// allocating a mostly empty grid
+/////////////////////////////////////////////////
+constexpr size_t kMaxGridCellsPerQuad = 64;
+
+/////////////////////////////////////////////////
+/// @brief Bit pattern of a coordinate with -0.0f folded into 0.0f
+/////////////////////////////////////////////////
+std::uint32_t GetCoordinateBits(float value) {
+  return std::bit_cast<std::uint32_t>(value == 0.0f ? 0.0f : value);
+}
+
+/////////////////////////////////////////////////
+/// @brief The plane, facing and color a mergeable quad belongs to
+/////////////////////////////////////////////////
+struct PlaneKey {
+  std::uint32_t m_plane_bits;
+  std::uint32_t m_color;
+  std::uint8_t m_axis;
+  bool m_positive;
+
+  bool operator==(const PlaneKey &) const = default;
+};
+
+/////////////////////////////////////////////////
+struct PlaneKeyHash {
+  size_t operator()(const PlaneKey &key) const {
+    std::uint64_t hash =
+        (static_cast<std::uint64_t>(key.m_plane_bits) << 32) | key.m_color;
+    hash ^= (static_cast<std::uint64_t>(key.m_axis) << 1 | key.m_positive) *
+            0x9e3779b97f4a7c15ull;
+    hash *= 0xff51afd7ed558ccdull;
+    return static_cast<size_t>(hash ^ (hash >> 33));
+  }
+};
+
+/////////////////////////////////////////////////
+/// @brief In-plane extent of a mergeable quad, u and v being the two axes
+/// after the plane normal in cyclic order
+/////////////////////////////////////////////////
+struct PlaneRect {
+  float m_u0;
+  float m_u1;
+  float m_v0;
+  float m_v1;
+};
+
+/////////////////////////////////////////////////
+/// @brief Quads lying in one plane, with their extents
+/////////////////////////////////////////////////
+struct PlaneGroup {
+  PlaneKey m_key;
+  std::vector<PlaneRect> m_rects;
+  std::vector<PlaneRect> m_merged;
+};
+
+/////////////////////////////////////////////////
+/// @brief Classify a face, returning its plane and extent if it is an axis
+/// aligned single color rectangle
+/////////////////////////////////////////////////
+std::optional<std::pair<PlaneKey, PlaneRect>>
+ClassifyQuad(const std::vector<Vertex3> &vertices,
+             const std::array<size_t, 4> &face) {
+
+  if (face[3] == face[2])
+    return std::nullopt;
+
+  const sf::Color color = vertices[face[0]].m_color;
+  for (const size_t index : face) {
+    if (vertices[index].m_color != color)
+      return std::nullopt;
+  }
+
+  for (int axis = 0; axis < 3; ++axis) {
+    const float plane = vertices[face[0]].m_position[axis];
+    bool flat = true;
+    for (const size_t index : face)
+      flat = flat && vertices[index].m_position[axis] == plane;
+    if (!flat)
+      continue;
+
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    std::array<glm::vec2, 4> corners;
+    for (size_t corner = 0; corner < 4; ++corner) {
+      const glm::vec3 &position = vertices[face[corner]].m_position;
+      corners[corner] = glm::vec2(position[u], position[v]);
+    }
+
+    // every edge has to run along exactly one of u and v
+    for (size_t corner = 0; corner < 4; ++corner) {
+      const glm::vec2 edge = corners[(corner + 1) % 4] - corners[corner];
+      if ((edge.x != 0.0f) == (edge.y != 0.0f))
+        return std::nullopt;
+    }
+
+    const glm::vec2 first_edge = corners[1] - corners[0];
+    const glm::vec2 second_edge = corners[2] - corners[1];
+    const float winding =
+        first_edge.x * second_edge.y - first_edge.y * second_edge.x;
+
+    PlaneKey key{GetCoordinateBits(plane), color.toInteger(),
+                 static_cast<std::uint8_t>(axis), winding > 0.0f};
+    PlaneRect rect{std::min(corners[0].x, corners[2].x),
+                   std::max(corners[0].x, corners[2].x),
+                   std::min(corners[0].y, corners[2].y),
+                   std::max(corners[0].y, corners[2].y)};
+    return std::make_pair(key, rect);
+  }
+  return std::nullopt;
+}
+
+/////////////////////////////////////////////////
+/// @brief Sorted distinct values of a list of coordinates
+/////////////////////////////////////////////////
+std::vector<float> GetGridLines(std::vector<float> values) {
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  return values;
+}
+
+/////////////////////////////////////////////////
+size_t FindGridLine(const std::vector<float> &lines, float value) {
+  return static_cast<size_t>(
+      std::lower_bound(lines.begin(), lines.end(), value) - lines.begin());
+}
+
+/////////////////////////////////////////////////
+/// @brief Fill group.m_merged with the greedy cover of group.m_rects, or
+/// leave it empty if the group is not worth merging
+/////////////////////////////////////////////////
+void MergeGroup(PlaneGroup &group) {
+
+  if (group.m_rects.size() < 2)
+    return;
+
+  std::vector<float> u_values;
+  std::vector<float> v_values;
+  for (const PlaneRect &rect : group.m_rects) {
+    u_values.insert(u_values.end(), {rect.m_u0, rect.m_u1});
+    v_values.insert(v_values.end(), {rect.m_v0, rect.m_v1});
+  }
+  const std::vector<float> u_lines = GetGridLines(std::move(u_values));
+  const std::vector<float> v_lines = GetGridLines(std::move(v_values));
+  const size_t width = u_lines.size() - 1;
+  const size_t height = v_lines.size() - 1;
+  if (width * height > group.m_rects.size() * kMaxGridCellsPerQuad)
+    return;
+
+  // 0 empty, 1 covered, 2 covered and already part of an output rectangle
+  std::vector<std::uint8_t> cells(width * height, 0);
+  for (const PlaneRect &rect : group.m_rects) {
+    const size_t u_begin = FindGridLine(u_lines, rect.m_u0);
+    const size_t u_end = FindGridLine(u_lines, rect.m_u1);
+    const size_t v_begin = FindGridLine(v_lines, rect.m_v0);
+    const size_t v_end = FindGridLine(v_lines, rect.m_v1);
+    for (size_t v = v_begin; v < v_end; ++v)
+      std::fill(cells.begin() + v * width + u_begin,
+                cells.begin() + v * width + u_end, 1);
+  }
+
+  for (size_t v = 0; v < height; ++v) {
+    for (size_t u = 0; u < width; ++u) {
+      if (cells[v * width + u] != 1)
+        continue;
+
+      size_t u_end = u + 1;
+      while (u_end < width && cells[v * width + u_end] == 1)
+        ++u_end;
+
+      size_t v_end = v + 1;
+      while (v_end < height &&
+             std::all_of(cells.begin() + v_end * width + u,
+                         cells.begin() + v_end * width + u_end,
+                         [](std::uint8_t cell) { return cell == 1; })) {
+        ++v_end;
+      }
+
+      for (size_t row = v; row < v_end; ++row)
+        std::fill(cells.begin() + row * width + u,
+                  cells.begin() + row * width + u_end, 2);
+      group.m_merged.push_back(
+          {u_lines[u], u_lines[u_end], v_lines[v], v_lines[v_end]});
+    }
+  }
+
+  // nothing gained, keep the original faces
+  if (group.m_merged.size() >= group.m_rects.size())
+    group.m_merged.clear();
+}
+
+/////////////////////////////////////////////////
+/// @brief Identity of a corner vertex, as in vertex welding
+/////////////////////////////////////////////////
+struct CornerKey {
+  std::array<std::uint32_t, 3> m_position_bits;
+  std::uint32_t m_color;
+
+  bool operator==(const CornerKey &) const = default;
+};
+
+/////////////////////////////////////////////////
+struct CornerKeyHash {
+  size_t operator()(const CornerKey &key) const {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (const std::uint32_t word :
+         {key.m_position_bits[0], key.m_position_bits[1],
+          key.m_position_bits[2], key.m_color}) {
+      hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    return static_cast<size_t>(hash ^ (hash >> 29));
+  }
+};
+
+/////////////////////////////////////////////////
+CornerKey MakeCornerKey(const glm::vec3 &position, std::uint32_t color) {
+  return {{GetCoordinateBits(position.x), GetCoordinateBits(position.y),
+           GetCoordinateBits(position.z)},
+          color};
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+GreedyMesher::GreedyMesher(ThreadPool &thread_pool)
+    : m_thread_pool(thread_pool) {}
+
+/////////////////////////////////////////////////
+void GreedyMesher::Merge(std::vector<Vertex3> &vertices,
+                         std::vector<std::array<size_t, 4>> &faces) {
+
+  // group mergeable quads by plane, in order of first appearance so the
+  // output does not depend on hash table order
+  std::vector<PlaneGroup> groups;
+  std::unordered_map<PlaneKey, size_t, PlaneKeyHash> group_ids;
+  std::vector<std::optional<size_t>> face_groups(faces.size());
+  for (size_t i = 0; i < faces.size(); ++i) {
+    const auto classified = ClassifyQuad(vertices, faces[i]);
+    if (!classified)
+      continue;
+    auto [found, inserted] =
+        group_ids.try_emplace(classified->first, groups.size());
+    if (inserted)
+      groups.push_back({classified->first, {}, {}});
+    groups[found->second].m_rects.push_back(classified->second);
+    face_groups[i] = found->second;
+  }
+
+  m_thread_pool.ParallelFor(0, groups.size(), 1,
+                            [&](size_t begin, size_t end) {
+                              for (size_t g = begin; g < end; ++g)
+                                MergeGroup(groups[g]);
+                            });
+
+  // faces of merged groups are replaced, all others are kept in order
+  std::vector<std::array<size_t, 4>> merged_faces;
+  merged_faces.reserve(faces.size());
+  std::unordered_map<CornerKey, size_t, CornerKeyHash> corner_ids;
+  for (size_t i = 0; i < faces.size(); ++i) {
+    if (face_groups[i] && !groups[*face_groups[i]].m_merged.empty()) {
+      for (const size_t index : faces[i]) {
+        const Vertex3 &vertex = vertices[index];
+        corner_ids.try_emplace(
+            MakeCornerKey(vertex.m_position, vertex.m_color.toInteger()),
+            index);
+      }
+      continue;
+    }
+    merged_faces.push_back(faces[i]);
+  }
+
+  const size_t num_input_faces = faces.size();
+  const size_t num_input_vertices = vertices.size();
+  for (const PlaneGroup &group : groups) {
+    const PlaneKey &key = group.m_key;
+    const int u = (key.m_axis + 1) % 3;
+    const int v = (key.m_axis + 2) % 3;
+    const float plane = std::bit_cast<float>(key.m_plane_bits);
+
+    auto corner_for = [&](float u_value, float v_value) {
+      glm::vec3 position;
+      position[key.m_axis] = plane;
+      position[u] = u_value;
+      position[v] = v_value;
+      auto [found, inserted] = corner_ids.try_emplace(
+          MakeCornerKey(position, key.m_color), vertices.size());
+      if (inserted)
+        vertices.emplace_back(position, sf::Color(key.m_color));
+      return found->second;
+    };
+
+    for (const PlaneRect &rect : group.m_merged) {
+      std::array<size_t, 4> face{corner_for(rect.m_u0, rect.m_v0),
+                                 corner_for(rect.m_u1, rect.m_v0),
+                                 corner_for(rect.m_u1, rect.m_v1),
+                                 corner_for(rect.m_u0, rect.m_v1)};
+      // (u, v, normal) is right handed, so this order faces +axis
+      if (!key.m_positive)
+        std::swap(face[1], face[3]);
+      merged_faces.push_back(face);
+    }
+  }
+
+  faces = std::move(merged_faces);
+  std::cout << "[DEBUG] Greedy meshing merged " << num_input_faces
+            << " faces into " << faces.size() << ", adding "
+            << vertices.size() - num_input_vertices << " corner vertices."
+            << std::endl;
+}
+
+} // namespace projection_generator
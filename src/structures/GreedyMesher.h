@@ -0,0 +1,59 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the GreedyMesher class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ThreadPool.h"
+#include "Vertex3.h"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class GreedyMesher
+/// @brief Merges adjacent coplanar quads of one color into maximal
+/// rectangles.
+///
+/// Only axis aligned rectangular quads whose four corners share a color take
+/// part, which covers every face of a voxel export. They are grouped by
+/// plane, facing and color; each group is laid on a grid built from the
+/// distinct corner coordinates of its quads, and covered cells are swept
+/// row by row into rectangles that grow along u first and then along v.
+/// Groups are independent and are merged in parallel. Other faces pass
+/// through untouched. Corners of merged rectangles reuse existing vertices
+/// where possible; vertices that end up unused are left for the caller to
+/// drop.
+/////////////////////////////////////////////////
+class GreedyMesher {
+private:
+  ThreadPool &m_thread_pool;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Constructor
+  ///
+  /// @param thread_pool Pool used to merge plane groups in parallel
+  /////////////////////////////////////////////////
+  explicit GreedyMesher(ThreadPool &thread_pool);
+
+  /////////////////////////////////////////////////
+  /// @brief Replace mergeable quads in faces with merged rectangles, appending
+  /// corner vertices to vertices where no existing one fits
+  ///
+  /// @param vertices Vertex buffer the faces index into
+  /// @param faces Quads, a face with face[3] == face[2] is a triangle
+  /////////////////////////////////////////////////
+  void Merge(std::vector<Vertex3> &vertices,
+             std::vector<std::array<size_t, 4>> &faces);
+};
+} // namespace projection_generator
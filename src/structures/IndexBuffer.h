@@ -0,0 +1,137 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the IndexBuffer class template.
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief Meshes with at most this many vertices use 16 bit indices
+/////////////////////////////////////////////////
+inline constexpr std::size_t kMaxUInt16IndexedVertices =
+    std::size_t{std::numeric_limits<std::uint16_t>::max()} + 1;
+
+/////////////////////////////////////////////////
+/// @class IndexBuffer
+/// @brief Primitives of N vertex indices stored at the narrowest index width
+/// the mesh allows.
+///
+/// The index type is fixed when the buffer is built from the vertex count:
+/// uint16_t up to kMaxUInt16IndexedVertices vertices, uint32_t above. Hot
+/// loops call Visit to get a span typed on the real index width, so they are
+/// compiled once per width and never convert indices per element. operator[]
+/// widens to size_t for code that does not care.
+///
+/// @tparam N Number of indices per primitive (3 for triangles, 4 for quads)
+/////////////////////////////////////////////////
+template <std::size_t N> class IndexBuffer {
+public:
+  template <typename Index> using Storage = std::vector<std::array<Index, N>>;
+
+private:
+  std::variant<Storage<std::uint16_t>, Storage<std::uint32_t>> m_storage;
+
+public:
+  IndexBuffer() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Take ownership of primitives already at their final width
+  /////////////////////////////////////////////////
+  template <typename Index>
+  explicit IndexBuffer(Storage<Index> primitives)
+      : m_storage(std::move(primitives)) {}
+
+  /////////////////////////////////////////////////
+  /// @brief Narrow size_t primitives to the smallest index type that can
+  /// address num_vertices vertices
+  ///
+  /// @param primitives Primitives with full width indices
+  /// @param num_vertices Number of vertices the indices refer to
+  /////////////////////////////////////////////////
+  static IndexBuffer
+  Compact(const std::vector<std::array<std::size_t, N>> &primitives,
+          std::size_t num_vertices) {
+    auto narrow = [&primitives]<typename Index>() {
+      Storage<Index> narrowed(primitives.size());
+      for (std::size_t i = 0; i < primitives.size(); ++i) {
+        for (std::size_t corner = 0; corner < N; ++corner)
+          narrowed[i][corner] = static_cast<Index>(primitives[i][corner]);
+      }
+      return IndexBuffer(std::move(narrowed));
+    };
+    if (num_vertices <= kMaxUInt16IndexedVertices)
+      return narrow.template operator()<std::uint16_t>();
+    if (num_vertices - 1 <= std::numeric_limits<std::uint32_t>::max())
+      return narrow.template operator()<std::uint32_t>();
+    throw std::runtime_error("Mesh has too many vertices for 32 bit indices.");
+  }
+
+  std::size_t size() const {
+    return std::visit([](const auto &storage) { return storage.size(); },
+                      m_storage);
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /////////////////////////////////////////////////
+  /// @brief Bytes per index, 2 or 4
+  /////////////////////////////////////////////////
+  std::size_t GetIndexSize() const {
+    return std::holds_alternative<Storage<std::uint16_t>>(m_storage)
+               ? sizeof(std::uint16_t)
+               : sizeof(std::uint32_t);
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Primitive i with its indices widened to size_t
+  /////////////////////////////////////////////////
+  std::array<std::size_t, N> operator[](std::size_t i) const {
+    return std::visit(
+        [i](const auto &storage) {
+          std::array<std::size_t, N> primitive;
+          for (std::size_t corner = 0; corner < N; ++corner)
+            primitive[corner] = storage[i][corner];
+          return primitive;
+        },
+        m_storage);
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Call visitor with a std::span<const std::array<Index, N>> over
+  /// the primitives, Index being the stored width
+  /////////////////////////////////////////////////
+  template <typename Visitor> decltype(auto) Visit(Visitor &&visitor) const {
+    return std::visit(
+        [&visitor](const auto &storage) -> decltype(auto) {
+          return visitor(std::span(storage));
+        },
+        m_storage);
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Raw bytes of the primitives, for writing them out unchanged
+  /////////////////////////////////////////////////
+  std::span<const std::byte> GetBytes() const {
+    return Visit([](auto primitives) { return std::as_bytes(primitives); });
+  }
+};
+
+} // namespace projection_generator
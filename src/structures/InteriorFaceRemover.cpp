@@ -0,0 +1,155 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the InteriorFaceRemover class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "InteriorFaceRemover.h"
+#include "glm/geometric.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <unordered_map>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Faces are matched in 2^kShardBits independent hash tables
+/////////////////////////////////////////////////
+constexpr int kShardBits = 6;
+
+/////////////////////////////////////////////////
+/// @brief Faces handed to one task when hashing
+/////////////////////////////////////////////////
+constexpr size_t kHashGrain = 1 << 14;
+
+/////////////////////////////////////////////////
+/// @brief Sorted corner positions of a face, as bit patterns with -0.0f
+/// folded into 0.0f. A triangle repeats its last corner.
+/////////////////////////////////////////////////
+struct FaceKey {
+  std::array<std::array<std::uint32_t, 3>, 4> m_corners;
+
+  bool operator==(const FaceKey &) const = default;
+};
+
+/////////////////////////////////////////////////
+FaceKey MakeFaceKey(const std::vector<Vertex3> &vertices,
+                    const std::array<size_t, 4> &face) {
+  FaceKey key;
+  for (size_t corner = 0; corner < 4; ++corner) {
+    const glm::vec3 &position = vertices[face[corner]].m_position;
+    for (int axis = 0; axis < 3; ++axis) {
+      const float value = position[axis] == 0.0f ? 0.0f : position[axis];
+      key.m_corners[corner][axis] = std::bit_cast<std::uint32_t>(value);
+    }
+  }
+  std::sort(key.m_corners.begin(), key.m_corners.end());
+  return key;
+}
+
+/////////////////////////////////////////////////
+std::uint64_t HashFaceKey(const FaceKey &key) {
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+  for (const auto &corner : key.m_corners) {
+    for (const std::uint32_t word : corner)
+      hash = (hash ^ word) * 0x100000001b3ull;
+  }
+  // fold the low bits into the top ones used to pick the shard
+  hash ^= hash >> 29;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  return hash ^ (hash >> 32);
+}
+
+/////////////////////////////////////////////////
+struct FaceKeyHash {
+  size_t operator()(const FaceKey &key) const {
+    return static_cast<size_t>(HashFaceKey(key));
+  }
+};
+
+/////////////////////////////////////////////////
+/// @brief Face normal from the cross product of the diagonals, which works
+/// for triangles stored as [a, b, c, c] as well
+/////////////////////////////////////////////////
+glm::vec3 GetFaceNormal(const std::vector<Vertex3> &vertices,
+                        const std::array<size_t, 4> &face) {
+  return glm::cross(
+      vertices[face[2]].m_position - vertices[face[0]].m_position,
+      vertices[face[3]].m_position - vertices[face[1]].m_position);
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+InteriorFaceRemover::InteriorFaceRemover(ThreadPool &thread_pool)
+    : m_thread_pool(thread_pool) {}
+
+/////////////////////////////////////////////////
+size_t InteriorFaceRemover::Remove(const std::vector<Vertex3> &vertices,
+                                   std::vector<std::array<size_t, 4>> &faces) {
+
+  constexpr size_t kNumShards = size_t{1} << kShardBits;
+
+  std::vector<std::uint64_t> hashes(faces.size());
+  m_thread_pool.ParallelFor(
+      0, faces.size(), kHashGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+          hashes[i] = HashFaceKey(MakeFaceKey(vertices, faces[i]));
+      });
+
+  // stable counting sort by shard so matching inside a shard visits faces in
+  // file order and the result does not depend on scheduling
+  std::vector<size_t> shard_offsets(kNumShards + 1, 0);
+  for (const std::uint64_t hash : hashes)
+    ++shard_offsets[(hash >> (64 - kShardBits)) + 1];
+  for (size_t shard = 0; shard < kNumShards; ++shard)
+    shard_offsets[shard + 1] += shard_offsets[shard];
+
+  std::vector<size_t> shard_members(faces.size());
+  std::vector<size_t> cursors(shard_offsets.begin(), shard_offsets.end() - 1);
+  for (size_t i = 0; i < faces.size(); ++i)
+    shard_members[cursors[hashes[i] >> (64 - kShardBits)]++] = i;
+
+  std::vector<std::uint8_t> removed(faces.size(), 0);
+  m_thread_pool.ParallelFor(0, kNumShards, 1, [&](size_t begin, size_t end) {
+    for (size_t shard = begin; shard < end; ++shard) {
+      // faces seen so far per set of corners that still wait for an
+      // opposite partner
+      std::unordered_map<FaceKey, std::vector<size_t>, FaceKeyHash> open;
+      for (size_t slot = shard_offsets[shard]; slot < shard_offsets[shard + 1];
+           ++slot) {
+        const size_t i = shard_members[slot];
+        std::vector<size_t> &waiting = open[MakeFaceKey(vertices, faces[i])];
+        const glm::vec3 normal = GetFaceNormal(vertices, faces[i]);
+
+        // every waiting face in a set points the same way, so checking one
+        // decides whether this face closes a pair
+        if (!waiting.empty() &&
+            glm::dot(normal, GetFaceNormal(vertices, faces[waiting.back()])) <
+                0.0f) {
+          removed[waiting.back()] = 1;
+          removed[i] = 1;
+          waiting.pop_back();
+        } else {
+          waiting.push_back(i);
+        }
+      }
+    }
+  });
+
+  size_t num_kept = 0;
+  for (size_t i = 0; i < faces.size(); ++i) {
+    if (!removed[i])
+      faces[num_kept++] = faces[i];
+  }
+  const size_t num_removed = faces.size() - num_kept;
+  faces.resize(num_kept);
+  return num_removed;
+}
+
+} // namespace projection_generator
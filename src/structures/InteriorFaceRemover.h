@@ -0,0 +1,57 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the InteriorFaceRemover class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ThreadPool.h"
+#include "Vertex3.h"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class InteriorFaceRemover
+/// @brief Drops pairs of coincident, opposite facing faces.
+///
+/// Voxel exports put a face on both sides of the wall between two touching
+/// voxels. Neither can be seen, but both survive backface culling from one
+/// side or the other. Faces are hashed on their sorted corner positions (color
+/// is ignored, the two voxels may differ), the hashes are sharded and each
+/// shard is matched on its own thread. Within a set of faces with the same
+/// corners, each face is paired with one of the opposite facing and both are
+/// removed; unpaired faces are kept.
+/////////////////////////////////////////////////
+class InteriorFaceRemover {
+private:
+  ThreadPool &m_thread_pool;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Constructor
+  ///
+  /// @param thread_pool Pool used to hash and match faces in parallel
+  /////////////////////////////////////////////////
+  explicit InteriorFaceRemover(ThreadPool &thread_pool);
+
+  /////////////////////////////////////////////////
+  /// @brief Remove coincident opposite face pairs from faces, keeping the
+  /// order of the rest. Vertices are not touched.
+  ///
+  /// @param vertices Vertex buffer the faces index into
+  /// @param faces Quads, a face with face[3] == face[2] is a triangle
+  /// @return Number of faces removed
+  /////////////////////////////////////////////////
+  size_t Remove(const std::vector<Vertex3> &vertices,
+                std::vector<std::array<size_t, 4>> &faces);
+};
+} // namespace projection_generator
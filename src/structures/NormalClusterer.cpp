@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the NormalClusterer class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "NormalClusterer.h"
+#include <cstdint>
+#include <span>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Triangles handed to one task
+/////////////////////////////////////////////////
+constexpr size_t kClusterGrain = 1 << 14;
+
+/////////////////////////////////////////////////
+/// @brief Cells along each side of a cube map face. Four keeps the spread of
+/// a bin under about 20 degrees, tight enough that only bins near the
+/// silhouette need per triangle tests.
+/////////////////////////////////////////////////
+constexpr std::uint32_t kBinsPerSide = 4;
+
+/////////////////////////////////////////////////
+/// @brief Bin of zero area triangles, after the six faces of bins
+/////////////////////////////////////////////////
+constexpr std::uint32_t kDegenerateBin = 6 * kBinsPerSide * kBinsPerSide;
+
+/////////////////////////////////////////////////
+/// @brief Unit normal of the triangle a, b, c (right hand winding), or zero
+/// if it has no area
+/////////////////////////////////////////////////
+glm::vec3 GetUnitNormal(const glm::vec3 &a, const glm::vec3 &b,
+                        const glm::vec3 &c) {
+  const glm::vec3 normal = glm::cross(b - a, c - a);
+  const float length = glm::length(normal);
+  if (!(length > 0.0f) || !std::isfinite(length))
+    return glm::vec3(0.0f);
+  return normal / length;
+}
+
+/////////////////////////////////////////////////
+std::uint32_t GetNormalBin(const glm::vec3 &normal) {
+  const glm::vec3 magnitude(std::abs(normal.x), std::abs(normal.y),
+                            std::abs(normal.z));
+  int axis = 0;
+  if (magnitude.y > magnitude[axis])
+    axis = 1;
+  if (magnitude.z > magnitude[axis])
+    axis = 2;
+  if (magnitude[axis] == 0.0f)
+    return kDegenerateBin;
+
+  const std::uint32_t face =
+      static_cast<std::uint32_t>(axis * 2 + (normal[axis] < 0.0f ? 1 : 0));
+  auto cell = [&](float component) {
+    // component / magnitude is in [-1, 1]
+    const float t = (component / magnitude[axis] + 1.0f) * 0.5f;
+    return std::min(static_cast<std::uint32_t>(t * kBinsPerSide),
+                    kBinsPerSide - 1);
+  };
+  const std::uint32_t u = cell(normal[(axis + 1) % 3]);
+  const std::uint32_t v = cell(normal[(axis + 2) % 3]);
+  return (face * kBinsPerSide + v) * kBinsPerSide + u;
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+NormalClusterer::NormalClusterer(ThreadPool &thread_pool)
+    : m_thread_pool(thread_pool) {}
+
+/////////////////////////////////////////////////
+void NormalClusterer::SortByNormal(
+    const std::vector<Vertex3> &vertices,
+    std::vector<std::array<size_t, 3>> &triangles) {
+
+  std::vector<std::uint32_t> bins(triangles.size());
+  m_thread_pool.ParallelFor(
+      0, triangles.size(), kClusterGrain, [&](size_t first, size_t last) {
+        for (size_t t = first; t < last; ++t) {
+          const auto &triangle = triangles[t];
+          bins[t] = GetNormalBin(GetUnitNormal(
+              vertices[triangle[0]].m_position,
+              vertices[triangle[1]].m_position,
+              vertices[triangle[2]].m_position));
+        }
+      });
+
+  // counting sort, stable so triangles keep their order within a bin
+  std::array<size_t, kDegenerateBin + 2> starts{};
+  for (const std::uint32_t bin : bins)
+    ++starts[bin + 1];
+  for (size_t b = 1; b < starts.size(); ++b)
+    starts[b] += starts[b - 1];
+
+  std::vector<std::array<size_t, 3>> sorted(triangles.size());
+  for (size_t t = 0; t < triangles.size(); ++t)
+    sorted[starts[bins[t]]++] = triangles[t];
+  triangles = std::move(sorted);
+}
+
+/////////////////////////////////////////////////
+void NormalClusterer::ComputeNormals(const VertexSoA &vertices,
+                                     const IndexBuffer<3> &triangles,
+                                     TriangleNormals &normals) {
+
+  const std::span<const float> xs = vertices.GetX();
+  const std::span<const float> ys = vertices.GetY();
+  const std::span<const float> zs = vertices.GetZ();
+  auto position = [&](size_t i) { return glm::vec3(xs[i], ys[i], zs[i]); };
+
+  normals.resize(triangles.size());
+  triangles.Visit([&](auto primitives) {
+    m_thread_pool.ParallelFor(
+        0, primitives.size(), kClusterGrain, [&](size_t first, size_t last) {
+          for (size_t t = first; t < last; ++t) {
+            const auto &triangle = primitives[t];
+            normals.Set(t, GetUnitNormal(position(triangle[0]),
+                                         position(triangle[1]),
+                                         position(triangle[2])));
+          }
+        });
+  });
+}
+
+} // namespace projection_generator
@@ -0,0 +1,118 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the NormalClusterer class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "AlignedAllocator.h"
+#include "IndexBuffer.h"
+#include "ThreadPool.h"
+#include "Vertex3.h"
+#include "VertexSoA.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @brief A unit normal faces a unit view direction when their dot product
+/// is above this. Triangles below it are edge on and project to slivers
+/// with no area, so culling them keeps the result of exactly axis aligned
+/// views from depending on rounding.
+/////////////////////////////////////////////////
+constexpr float kMinFacing = 1e-5f;
+
+/////////////////////////////////////////////////
+/// @class TriangleNormals
+/// @brief One unit normal per triangle, stored one aligned component array
+/// at a time like VertexSoA so facing tests can run several triangles per
+/// instruction. Indexing yields glm::vec3 values.
+/////////////////////////////////////////////////
+class TriangleNormals {
+private:
+  AlignedVector<float> m_x;
+  AlignedVector<float> m_y;
+  AlignedVector<float> m_z;
+
+public:
+  void resize(std::size_t size) {
+    m_x.resize(size);
+    m_y.resize(size);
+    m_z.resize(size);
+  }
+
+  std::size_t size() const { return m_x.size(); }
+
+  glm::vec3 operator[](std::size_t index) const {
+    return glm::vec3(m_x[index], m_y[index], m_z[index]);
+  }
+
+  void Set(std::size_t index, const glm::vec3 &normal) {
+    m_x[index] = normal.x;
+    m_y[index] = normal.y;
+    m_z[index] = normal.z;
+  }
+
+  std::span<const float> GetX() const { return m_x; }
+
+  std::span<const float> GetY() const { return m_y; }
+
+  std::span<const float> GetZ() const { return m_z; }
+};
+
+/////////////////////////////////////////////////
+/// @class NormalClusterer
+/// @brief Orders triangles by the direction of their normal and computes
+/// the normals.
+///
+/// Normals are binned on a cube map: the dominant axis and its sign pick one
+/// of six faces, and the other two components pick a cell of a small grid on
+/// that face. Sorting triangles by bin puts triangles facing the same way
+/// next to each other, so the facing arcs VisibilityIndex finds change in
+/// long runs. Zero area triangles get a bin of their own.
+/////////////////////////////////////////////////
+class NormalClusterer {
+private:
+  ThreadPool &m_thread_pool;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Constructor
+  ///
+  /// @param thread_pool Pool used to compute normals and bins in parallel
+  /////////////////////////////////////////////////
+  explicit NormalClusterer(ThreadPool &thread_pool);
+
+  /////////////////////////////////////////////////
+  /// @brief Stable sort of triangles by normal bin
+  ///
+  /// @param vertices Vertex buffer the triangles index into
+  /// @param triangles Triangles to reorder in place
+  /////////////////////////////////////////////////
+  void SortByNormal(const std::vector<Vertex3> &vertices,
+                    std::vector<std::array<size_t, 3>> &triangles);
+
+  /////////////////////////////////////////////////
+  /// @brief Compute unit triangle normals, zero for degenerate triangles
+  ///
+  /// @param vertices Vertex buffer the triangles index into
+  /// @param triangles Triangles to compute the normals of
+  /// @param normals Receives one normal per triangle
+  /////////////////////////////////////////////////
+  void ComputeNormals(const VertexSoA &vertices,
+                      const IndexBuffer<3> &triangles,
+                      TriangleNormals &normals);
+};
+} // namespace projection_generator
@@ -0,0 +1,82 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the PolygonList class.
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class PolygonList
+/// @brief Polygons with any number of corners, stored as one flat index
+/// array plus the offset at which each polygon starts (compressed sparse
+/// rows), so a mesh of n-gons costs two allocations rather than one per face.
+/////////////////////////////////////////////////
+class PolygonList {
+private:
+  /////////////////////////////////////////////////
+  /// @brief Polygon i uses m_indices[m_offsets[i], m_offsets[i + 1])
+  /////////////////////////////////////////////////
+  std::vector<size_t> m_offsets{0};
+
+  std::vector<size_t> m_indices;
+
+public:
+  PolygonList() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Take ownership of ready made arrays, throws std::runtime_error if
+  /// the offsets do not describe indices
+  ///
+  /// @param offsets Start of every polygon plus one past the end of the last
+  /// @param indices Corner vertex indices of all polygons back to back
+  /////////////////////////////////////////////////
+  PolygonList(std::vector<size_t> offsets, std::vector<size_t> indices)
+      : m_offsets(std::move(offsets)), m_indices(std::move(indices)) {
+    if (m_offsets.empty() || m_offsets.front() != 0 ||
+        m_offsets.back() != m_indices.size()) {
+      throw std::runtime_error("PolygonList offsets do not match indices.");
+    }
+  }
+
+  void Reserve(size_t num_polygons, size_t num_indices) {
+    m_offsets.reserve(num_polygons + 1);
+    m_indices.reserve(num_indices);
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Append one polygon
+  /////////////////////////////////////////////////
+  void Add(std::span<const size_t> polygon) {
+    m_indices.insert(m_indices.end(), polygon.begin(), polygon.end());
+    m_offsets.push_back(m_indices.size());
+  }
+
+  size_t size() const { return m_offsets.size() - 1; }
+
+  bool empty() const { return size() == 0; }
+
+  std::span<const size_t> operator[](size_t i) const {
+    return std::span(m_indices).subspan(m_offsets[i],
+                                        m_offsets[i + 1] - m_offsets[i]);
+  }
+
+  const std::vector<size_t> &GetOffsets() const { return m_offsets; }
+
+  const std::vector<size_t> &GetIndices() const { return m_indices; }
+};
+
+} // namespace projection_generator
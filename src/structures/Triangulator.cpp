@@ -0,0 +1,253 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the Triangulator class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "Triangulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+namespace projection_generator {
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief Faces handed to one task
+/////////////////////////////////////////////////
+constexpr size_t kTriangulateGrain = 1 << 12;
+
+/////////////////////////////////////////////////
+/// @brief Working memory for ear clipping, reused for every polygon a task
+/// handles
+/////////////////////////////////////////////////
+struct EarClipScratch {
+  std::vector<glm::vec2> m_points;
+  std::vector<std::uint32_t> m_next;
+  std::vector<std::uint32_t> m_previous;
+};
+
+/////////////////////////////////////////////////
+float Cross(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c) {
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+/////////////////////////////////////////////////
+bool IsInsideTriangle(const glm::vec2 &point, const glm::vec2 &a,
+                      const glm::vec2 &b, const glm::vec2 &c,
+                      float orientation) {
+  return Cross(a, b, point) * orientation >= 0.0f &&
+         Cross(b, c, point) * orientation >= 0.0f &&
+         Cross(c, a, point) * orientation >= 0.0f;
+}
+
+/////////////////////////////////////////////////
+/// @brief Write the polygon's n - 2 triangles to emit(a, b, c)
+/////////////////////////////////////////////////
+template <typename Emit>
+void TriangulatePolygon(const std::vector<Vertex3> &vertices,
+                        std::span<const size_t> polygon,
+                        EarClipScratch &scratch, Emit emit) {
+
+  const size_t num_corners = polygon.size();
+  if (num_corners == 3) {
+    emit(polygon[0], polygon[1], polygon[2]);
+    return;
+  }
+
+  // Newell normal, robust for slightly non planar polygons
+  glm::vec3 normal(0.0f);
+  for (size_t i = 0; i < num_corners; ++i) {
+    const glm::vec3 &current = vertices[polygon[i]].m_position;
+    const glm::vec3 &next = vertices[polygon[(i + 1) % num_corners]].m_position;
+    normal.x += (current.y - next.y) * (current.z + next.z);
+    normal.y += (current.z - next.z) * (current.x + next.x);
+    normal.z += (current.x - next.x) * (current.y + next.y);
+  }
+  int axis = 0;
+  for (int candidate = 1; candidate < 3; ++candidate) {
+    if (std::abs(normal[candidate]) > std::abs(normal[axis]))
+      axis = candidate;
+  }
+  const int u = (axis + 1) % 3;
+  const int v = (axis + 2) % 3;
+  const float orientation = normal[axis] < 0.0f ? -1.0f : 1.0f;
+
+  scratch.m_points.resize(num_corners);
+  for (size_t i = 0; i < num_corners; ++i) {
+    const glm::vec3 &position = vertices[polygon[i]].m_position;
+    scratch.m_points[i] = glm::vec2(position[u], position[v]);
+  }
+  const std::vector<glm::vec2> &points = scratch.m_points;
+
+  bool convex = true;
+  for (size_t i = 0; i < num_corners && convex; ++i) {
+    convex = Cross(points[i], points[(i + 1) % num_corners],
+                   points[(i + 2) % num_corners]) *
+                 orientation >=
+             0.0f;
+  }
+  if (convex) {
+    for (size_t i = 1; i + 1 < num_corners; ++i)
+      emit(polygon[0], polygon[i], polygon[i + 1]);
+    return;
+  }
+
+  scratch.m_next.resize(num_corners);
+  scratch.m_previous.resize(num_corners);
+  for (size_t i = 0; i < num_corners; ++i) {
+    scratch.m_next[i] = static_cast<std::uint32_t>((i + 1) % num_corners);
+    scratch.m_previous[i] =
+        static_cast<std::uint32_t>((i + num_corners - 1) % num_corners);
+  }
+  std::vector<std::uint32_t> &next = scratch.m_next;
+  std::vector<std::uint32_t> &previous = scratch.m_previous;
+
+  auto is_ear = [&](std::uint32_t corner) {
+    const std::uint32_t a = previous[corner];
+    const std::uint32_t c = next[corner];
+    if (Cross(points[a], points[corner], points[c]) * orientation <= 0.0f)
+      return false;
+    for (std::uint32_t other = next[c]; other != a; other = next[other]) {
+      const glm::vec2 &point = points[other];
+      // corners repeated by the polygon do not block an ear
+      if (point == points[a] || point == points[corner] ||
+          point == points[c])
+        continue;
+      if (IsInsideTriangle(point, points[a], points[corner], points[c],
+                           orientation))
+        return false;
+    }
+    return true;
+  };
+
+  std::uint32_t corner = 0;
+  size_t remaining = num_corners;
+  size_t tried = 0;
+  while (remaining > 3) {
+    // a self intersecting or degenerate polygon can run out of ears; clip
+    // anyway so every polygon still gives n - 2 triangles
+    if (is_ear(corner) || tried == remaining) {
+      emit(polygon[previous[corner]], polygon[corner], polygon[next[corner]]);
+      next[previous[corner]] = next[corner];
+      previous[next[corner]] = previous[corner];
+      corner = previous[corner];
+      --remaining;
+      tried = 0;
+    } else {
+      corner = next[corner];
+      ++tried;
+    }
+  }
+  emit(polygon[previous[corner]], polygon[corner], polygon[next[corner]]);
+}
+
+/////////////////////////////////////////////////
+/// @brief Corners of a Fragment3D face, three for a triangle stored as
+/// [a, b, c, c]
+/////////////////////////////////////////////////
+std::span<const size_t> GetFaceCorners(const std::array<size_t, 4> &face) {
+  return std::span(face).first(face[3] == face[2] ? 3 : 4);
+}
+
+} // namespace
+
+/////////////////////////////////////////////////
+Triangulator::Triangulator(ThreadPool &thread_pool)
+    : m_thread_pool(thread_pool) {}
+
+/////////////////////////////////////////////////
+std::vector<std::array<size_t, 4>>
+Triangulator::SplitPolygons(const std::vector<Vertex3> &vertices,
+                            const PolygonList &polygons) {
+
+  // one face per triangle or quad, n - 2 per larger polygon
+  auto face_count = [](size_t num_corners) {
+    return num_corners <= 4 ? size_t{1} : num_corners - 2;
+  };
+
+  const size_t num_polygons = polygons.size();
+  const size_t num_chunks =
+      (num_polygons + kTriangulateGrain - 1) / kTriangulateGrain;
+  std::vector<size_t> chunk_offsets(num_chunks + 1, 0);
+  m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; ++c) {
+      const size_t end = std::min(num_polygons, (c + 1) * kTriangulateGrain);
+      for (size_t i = c * kTriangulateGrain; i < end; ++i) {
+        if (polygons[i].size() < 3) {
+          throw std::runtime_error("Face has fewer than 3 vertices.");
+        }
+        chunk_offsets[c + 1] += face_count(polygons[i].size());
+      }
+    }
+  });
+  for (size_t c = 0; c < num_chunks; ++c)
+    chunk_offsets[c + 1] += chunk_offsets[c];
+
+  std::vector<std::array<size_t, 4>> faces(chunk_offsets[num_chunks]);
+  m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+    EarClipScratch scratch;
+    for (size_t c = first; c < last; ++c) {
+      std::array<size_t, 4> *out = faces.data() + chunk_offsets[c];
+      const size_t end = std::min(num_polygons, (c + 1) * kTriangulateGrain);
+      for (size_t i = c * kTriangulateGrain; i < end; ++i) {
+        const std::span<const size_t> polygon = polygons[i];
+        if (polygon.size() == 3) {
+          *out++ = {polygon[0], polygon[1], polygon[2], polygon[2]};
+        } else if (polygon.size() == 4) {
+          *out++ = {polygon[0], polygon[1], polygon[2], polygon[3]};
+        } else {
+          TriangulatePolygon(vertices, polygon, scratch,
+                             [&out](size_t a, size_t b, size_t c) {
+                               *out++ = {a, b, c, c};
+                             });
+        }
+      }
+    }
+  });
+
+  return faces;
+}
+
+/////////////////////////////////////////////////
+std::vector<std::array<size_t, 3>>
+Triangulator::Triangulate(const std::vector<Vertex3> &vertices,
+                          const std::vector<std::array<size_t, 4>> &faces) {
+
+  const size_t num_chunks =
+      (faces.size() + kTriangulateGrain - 1) / kTriangulateGrain;
+  std::vector<size_t> chunk_offsets(num_chunks + 1, 0);
+  m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+    for (size_t c = first; c < last; ++c) {
+      const size_t end = std::min(faces.size(), (c + 1) * kTriangulateGrain);
+      for (size_t i = c * kTriangulateGrain; i < end; ++i)
+        chunk_offsets[c + 1] += GetFaceCorners(faces[i]).size() - 2;
+    }
+  });
+  for (size_t c = 0; c < num_chunks; ++c)
+    chunk_offsets[c + 1] += chunk_offsets[c];
+
+  std::vector<std::array<size_t, 3>> triangles(chunk_offsets[num_chunks]);
+  m_thread_pool.ParallelFor(0, num_chunks, 1, [&](size_t first, size_t last) {
+    EarClipScratch scratch;
+    for (size_t c = first; c < last; ++c) {
+      std::array<size_t, 3> *out = triangles.data() + chunk_offsets[c];
+      const size_t end = std::min(faces.size(), (c + 1) * kTriangulateGrain);
+      for (size_t i = c * kTriangulateGrain; i < end; ++i) {
+        TriangulatePolygon(vertices, GetFaceCorners(faces[i]), scratch,
+                           [&out](size_t a, size_t b, size_t c) {
+                             *out++ = {a, b, c};
+                           });
+      }
+    }
+  });
+
+  return triangles;
+}
+
+} // namespace projection_generator
@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the Triangulator class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "PolygonList.h"
+#include "ThreadPool.h"
+#include "Vertex3.h"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class Triangulator
+/// @brief Splits polygons of any size into triangles.
+///
+/// Each polygon is projected onto the plane its Newell normal is closest to.
+/// Convex polygons are fanned from their first corner; concave ones are ear
+/// clipped. A polygon of n corners always gives n - 2 triangles, so output
+/// offsets are a prefix sum over the input and every face is written straight
+/// to its final slot from the thread pool. The ear clipper's scratch buffers
+/// are owned per task, not per face.
+/////////////////////////////////////////////////
+class Triangulator {
+private:
+  ThreadPool &m_thread_pool;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Constructor
+  ///
+  /// @param thread_pool Pool used to triangulate faces in parallel
+  /////////////////////////////////////////////////
+  explicit Triangulator(ThreadPool &thread_pool);
+
+  /////////////////////////////////////////////////
+  /// @brief Convert polygons to Fragment3D faces: triangles and quads are
+  /// kept as they are, larger polygons become triangles stored with a
+  /// repeated last index. Throws std::runtime_error on polygons with fewer
+  /// than three corners.
+  ///
+  /// @param vertices Vertex buffer the polygons index into
+  /// @param polygons Polygons from the object file
+  /////////////////////////////////////////////////
+  std::vector<std::array<size_t, 4>>
+  SplitPolygons(const std::vector<Vertex3> &vertices,
+                const PolygonList &polygons);
+
+  /////////////////////////////////////////////////
+  /// @brief Triangulate Fragment3D faces: triangles pass through, convex
+  /// quads are split from corner 0 and concave quads through their reflex
+  /// corner
+  ///
+  /// @param vertices Vertex buffer the faces index into
+  /// @param faces Quads, a face with face[3] == face[2] is a triangle
+  /////////////////////////////////////////////////
+  std::vector<std::array<size_t, 3>>
+  Triangulate(const std::vector<Vertex3> &vertices,
+              const std::vector<std::array<size_t, 4>> &faces);
+};
+} // namespace projection_generator
@@ -14,6 +14,12 @@ namespace projection_generator {
 /////////////////////////////////////////////////
 struct Vertex3 {
 
+  /////////////////////////////////////////////////
+  /// @brief Default constructor so vertex buffers can be pre-sized and
+  /// filled in place by the loaders
+  /////////////////////////////////////////////////
+  Vertex3() = default;
+
   /////////////////////////////////////////////////
   /// @brief Full constructor for Vertex3
   ///
@@ -25,7 +31,7 @@ struct Vertex3 {
   /////////////////////////////////////////////////
   /// @brief 3D vector representing the vertex position
   /////////////////////////////////////////////////
-  glm::vec3 m_position;
+  glm::vec3 m_position{0.0f};
 
   /////////////////////////////////////////////////
   /// @brief Color of the vertex
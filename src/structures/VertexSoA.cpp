@@ -0,0 +1,35 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the VertexSoA class.
+/////////////////////////////////////////////////
+
+#include "VertexSoA.h"
+#include <stdexcept>
+#include <utility>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+VertexSoA::VertexSoA(const std::vector<Vertex3> &vertices)
+    : m_x(vertices.size()), m_y(vertices.size()), m_z(vertices.size()),
+      m_colors(vertices.size()) {
+  for (std::size_t i = 0; i < vertices.size(); ++i) {
+    m_x[i] = vertices[i].m_position.x;
+    m_y[i] = vertices[i].m_position.y;
+    m_z[i] = vertices[i].m_position.z;
+    m_colors[i] = vertices[i].m_color;
+  }
+}
+
+/////////////////////////////////////////////////
+VertexSoA::VertexSoA(AlignedVector<float> x, AlignedVector<float> y,
+                     AlignedVector<float> z, AlignedVector<sf::Color> colors)
+    : m_x(std::move(x)), m_y(std::move(y)), m_z(std::move(z)),
+      m_colors(std::move(colors)) {
+  if (m_y.size() != m_x.size() || m_z.size() != m_x.size() ||
+      m_colors.size() != m_x.size()) {
+    throw std::runtime_error("VertexSoA component arrays differ in length.");
+  }
+}
+
+} // namespace projection_generator
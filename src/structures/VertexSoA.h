@@ -0,0 +1,152 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the VertexSoA class.
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "AlignedAllocator.h"
+#include "Vertex3.h"
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class VertexSoA
+/// @brief Vertex storage split into one aligned array per component.
+///
+/// Positions live in separate x, y and z float arrays and colors in a packed
+/// array next to them, so a loop that only transforms positions streams
+/// contiguous floats and never touches color bytes. Indexing or iterating
+/// yields Vertex3 values, which keeps code written against a
+/// std::vector<Vertex3> working unchanged.
+/////////////////////////////////////////////////
+class VertexSoA {
+private:
+  AlignedVector<float> m_x;
+  AlignedVector<float> m_y;
+  AlignedVector<float> m_z;
+  AlignedVector<sf::Color> m_colors;
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Random access iterator producing Vertex3 values
+  /////////////////////////////////////////////////
+  class Iterator {
+  private:
+    const VertexSoA *m_owner{nullptr};
+    std::ptrdiff_t m_index{0};
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Vertex3;
+    using difference_type = std::ptrdiff_t;
+    using reference = Vertex3;
+
+    Iterator() = default;
+    Iterator(const VertexSoA *owner, std::ptrdiff_t index)
+        : m_owner(owner), m_index(index) {}
+
+    Vertex3 operator*() const {
+      return (*m_owner)[static_cast<std::size_t>(m_index)];
+    }
+    Vertex3 operator[](difference_type offset) const {
+      return *(*this + offset);
+    }
+    Iterator &operator++() {
+      ++m_index;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator previous = *this;
+      ++m_index;
+      return previous;
+    }
+    Iterator &operator--() {
+      --m_index;
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator previous = *this;
+      --m_index;
+      return previous;
+    }
+    Iterator &operator+=(difference_type offset) {
+      m_index += offset;
+      return *this;
+    }
+    Iterator &operator-=(difference_type offset) {
+      m_index -= offset;
+      return *this;
+    }
+    friend Iterator operator+(Iterator iterator, difference_type offset) {
+      return iterator += offset;
+    }
+    friend Iterator operator+(difference_type offset, Iterator iterator) {
+      return iterator += offset;
+    }
+    friend Iterator operator-(Iterator iterator, difference_type offset) {
+      return iterator -= offset;
+    }
+    friend difference_type operator-(const Iterator &lhs,
+                                     const Iterator &rhs) {
+      return lhs.m_index - rhs.m_index;
+    }
+    friend bool operator==(const Iterator &lhs, const Iterator &rhs) {
+      return lhs.m_index == rhs.m_index;
+    }
+    friend auto operator<=>(const Iterator &lhs, const Iterator &rhs) {
+      return lhs.m_index <=> rhs.m_index;
+    }
+  };
+
+  VertexSoA() = default;
+
+  /////////////////////////////////////////////////
+  /// @brief Split interleaved vertices into component arrays
+  ///
+  /// @param vertices Vertices as produced by the loaders
+  /////////////////////////////////////////////////
+  explicit VertexSoA(const std::vector<Vertex3> &vertices);
+
+  /////////////////////////////////////////////////
+  /// @brief Take ownership of ready made component arrays, throws
+  /// std::runtime_error if their lengths differ
+  /////////////////////////////////////////////////
+  VertexSoA(AlignedVector<float> x, AlignedVector<float> y,
+            AlignedVector<float> z, AlignedVector<sf::Color> colors);
+
+  std::size_t size() const { return m_x.size(); }
+
+  bool empty() const { return m_x.empty(); }
+
+  Vertex3 operator[](std::size_t index) const {
+    return Vertex3(glm::vec3(m_x[index], m_y[index], m_z[index]),
+                   m_colors[index]);
+  }
+
+  Iterator begin() const { return {this, 0}; }
+
+  Iterator end() const {
+    return {this, static_cast<std::ptrdiff_t>(m_x.size())};
+  }
+
+  std::span<const float> GetX() const { return m_x; }
+
+  std::span<const float> GetY() const { return m_y; }
+
+  std::span<const float> GetZ() const { return m_z; }
+
+  std::span<const sf::Color> GetColors() const { return m_colors; }
+};
+
+} // namespace projection_generator
@@ -0,0 +1,136 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Implementation of the ThreadPool class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+ThreadPool::ThreadPool(size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  m_workers.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    m_workers.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+/////////////////////////////////////////////////
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(m_mutex);
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+  for (auto &worker : m_workers) {
+    worker.join();
+  }
+}
+
+/////////////////////////////////////////////////
+size_t ThreadPool::GetThreadCount() const { return m_workers.size(); }
+
+/////////////////////////////////////////////////
+void ThreadPool::Enqueue(std::function<void()> task) {
+  {
+    std::lock_guard lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+  m_condition.notify_one();
+}
+
+/////////////////////////////////////////////////
+void ThreadPool::WorkerLoop() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(m_mutex);
+      m_condition.wait(lock,
+                       [this]() { return m_stopping || !m_tasks.empty(); });
+      if (m_tasks.empty())
+        return; // stopping and drained
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    task();
+  }
+}
+
+/////////////////////////////////////////////////
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)> &body) {
+  if (begin >= end)
+    return;
+  grain = std::max<size_t>(grain, 1);
+  const size_t num_chunks = (end - begin + grain - 1) / grain;
+
+  if (num_chunks == 1) {
+    body(begin, end);
+    return;
+  }
+
+  // chunks are claimed from a shared counter by the caller and by helper
+  // tasks alike. A helper that only starts once every chunk is claimed
+  // returns without touching body, so the caller never waits on a task that
+  // is still sitting in the queue.
+  struct LoopState {
+    std::atomic<size_t> m_next_chunk{0};
+    std::atomic<size_t> m_finished_chunks{0};
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::exception_ptr m_error;
+  };
+  auto state = std::make_shared<LoopState>();
+  const auto *body_pointer = &body;
+
+  auto run_chunks = [state, body_pointer, begin, end, grain, num_chunks]() {
+    for (;;) {
+      const size_t chunk = state->m_next_chunk.fetch_add(1);
+      if (chunk >= num_chunks)
+        return;
+      const size_t chunk_begin = begin + chunk * grain;
+      const size_t chunk_end = std::min(end, chunk_begin + grain);
+      try {
+        (*body_pointer)(chunk_begin, chunk_end);
+      } catch (...) {
+        std::lock_guard lock(state->m_mutex);
+        if (!state->m_error)
+          state->m_error = std::current_exception();
+      }
+      if (state->m_finished_chunks.fetch_add(1) + 1 == num_chunks) {
+        std::lock_guard lock(state->m_mutex);
+        state->m_condition.notify_all();
+      }
+    }
+  };
+
+  const size_t num_helpers = std::min(m_workers.size(), num_chunks - 1);
+  for (size_t i = 0; i < num_helpers; ++i) {
+    Enqueue(run_chunks);
+  }
+  run_chunks();
+
+  std::unique_lock lock(state->m_mutex);
+  state->m_condition.wait(lock, [&]() {
+    return state->m_finished_chunks.load() == num_chunks;
+  });
+  if (state->m_error)
+    std::rethrow_exception(state->m_error);
+}
+
+/////////////////////////////////////////////////
+ThreadPool &ThreadPool::GetShared() {
+  static ThreadPool shared_pool;
+  return shared_pool;
+}
+
+} // namespace projection_generator
@@ -0,0 +1,100 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Declaration of the ThreadPool class
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Preprocessor Directives
+/////////////////////////////////////////////////
+#pragma once
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace projection_generator {
+
+/////////////////////////////////////////////////
+/// @class ThreadPool
+/// @brief Persistent set of worker threads that run submitted tasks.
+///
+/// ParallelFor lets the calling thread take part in the loop, so it is safe to
+/// call from inside a task that is itself running on the pool.
+/////////////////////////////////////////////////
+class ThreadPool {
+private:
+  std::vector<std::thread> m_workers;
+
+  std::deque<std::function<void()>> m_tasks;
+
+  std::mutex m_mutex;
+
+  std::condition_variable m_condition;
+
+  bool m_stopping{false};
+
+  void WorkerLoop();
+
+  void Enqueue(std::function<void()> task);
+
+public:
+  /////////////////////////////////////////////////
+  /// @brief Start the worker threads
+  ///
+  /// @param num_threads Number of workers, 0 picks the hardware concurrency
+  /////////////////////////////////////////////////
+  explicit ThreadPool(size_t num_threads = 0);
+
+  /////////////////////////////////////////////////
+  /// @brief Finish all queued tasks and join the workers
+  /////////////////////////////////////////////////
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t GetThreadCount() const;
+
+  /////////////////////////////////////////////////
+  /// @brief Queue a task and get a future for its result. Exceptions thrown
+  /// by the task are rethrown from the future.
+  /////////////////////////////////////////////////
+  template <typename Function>
+  std::future<std::invoke_result_t<Function>> Submit(Function &&function) {
+    using Result = std::invoke_result_t<Function>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(
+        std::forward<Function>(function));
+    std::future<Result> result = task->get_future();
+    Enqueue([task]() { (*task)(); });
+    return result;
+  }
+
+  /////////////////////////////////////////////////
+  /// @brief Run body over [begin, end) split into chunks of at most grain
+  /// items, blocking until every chunk is done. The first exception thrown by
+  /// any chunk is rethrown on the calling thread.
+  ///
+  /// @param begin First index
+  /// @param end One past the last index
+  /// @param grain Maximum number of indices handed to one call of body
+  /// @param body Called as body(chunk_begin, chunk_end)
+  /////////////////////////////////////////////////
+  void ParallelFor(size_t begin, size_t end, size_t grain,
+                   const std::function<void(size_t, size_t)> &body);
+
+  /////////////////////////////////////////////////
+  /// @brief Process wide pool sized to the hardware, created on first use
+  /////////////////////////////////////////////////
+  static ThreadPool &GetShared();
+};
+} // namespace projection_generator
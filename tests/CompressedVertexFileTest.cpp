@@ -0,0 +1,344 @@
+/////////////////////////////////////////////////
+/// @file
+/// @brief Round trip check of SnapshotEncoder output through
+/// CompressedVertexFileReader, including the raw and rANS channel codings,
+/// a channel at kMinRansBytes, constant channels, corrupt files and files
+/// left unclosed
+/////////////////////////////////////////////////
+
+/////////////////////////////////////////////////
+/// Headers
+/////////////////////////////////////////////////
+#include "CompressedVertexFile.h"
+#include "SnapshotWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace projection_generator;
+
+namespace {
+
+/////////////////////////////////////////////////
+/// @brief A snapshot that owns its vertices and depths
+/////////////////////////////////////////////////
+struct TestSnapshot {
+  std::vector<sf::Vertex> m_vertices;
+
+  std::vector<float> m_depth;
+};
+
+size_t g_num_failures = 0;
+
+/////////////////////////////////////////////////
+void Check(bool condition, const std::string &what) {
+  if (condition)
+    return;
+  ++g_num_failures;
+  std::cout << "[ERROR] CompressedVertexFileTest: " << what << std::endl;
+}
+
+/////////////////////////////////////////////////
+/// @brief Snapshot whose x channel has exactly num_bytes varint bytes: one
+/// jump to the top of the bounds and back takes three bytes each way, the
+/// zeros after it one byte each
+/////////////////////////////////////////////////
+TestSnapshot MakeThresholdSnapshot(size_t num_bytes) {
+  TestSnapshot snapshot;
+  snapshot.m_vertices.resize(num_bytes - 4);
+  snapshot.m_vertices[0].position = {65535.0f, 0.0f};
+  snapshot.m_vertices[0].color = sf::Color::White;
+  for (size_t i = 1; i < snapshot.m_vertices.size(); ++i) {
+    snapshot.m_vertices[i].position = {0.0f, 1.0f};
+    snapshot.m_vertices[i].color = sf::Color::White;
+  }
+  return snapshot;
+}
+
+/////////////////////////////////////////////////
+/// @brief Smooth outline with a small palette and depth, which the rANS
+/// coder compresses
+/////////////////////////////////////////////////
+TestSnapshot MakeSmoothSnapshot() {
+  TestSnapshot snapshot;
+  const sf::Color palette[] = {sf::Color::Red, sf::Color::Green,
+                               sf::Color::Blue};
+  for (size_t i = 0; i < 3000; ++i) {
+    const float angle = static_cast<float>(i) * 0.01f;
+    sf::Vertex vertex;
+    vertex.position = {400.0f + 2.0f * std::cos(angle),
+                       300.0f + 2.0f * std::sin(angle)};
+    vertex.color = palette[(i / 64) % 3];
+    snapshot.m_vertices.push_back(vertex);
+    snapshot.m_depth.push_back(std::sin(angle * 0.5f));
+  }
+  return snapshot;
+}
+
+/////////////////////////////////////////////////
+/// @brief Every vertex the same, so each channel is one repeated byte,
+/// whose rANS frequency is capped at kRansMaxFrequency
+/////////////////////////////////////////////////
+TestSnapshot MakeConstantSnapshot() {
+  TestSnapshot snapshot;
+  snapshot.m_vertices.resize(5000);
+  for (sf::Vertex &vertex : snapshot.m_vertices) {
+    vertex.position = {1.5f, -2.5f};
+    vertex.color = sf::Color::Green;
+  }
+  return snapshot;
+}
+
+/////////////////////////////////////////////////
+/// @brief Uniformly random positions and colors
+/////////////////////////////////////////////////
+TestSnapshot MakeNoiseSnapshot() {
+  TestSnapshot snapshot;
+  std::uint32_t state = 12345;
+  auto next = [&]() {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+  };
+  for (size_t i = 0; i < 4000; ++i) {
+    sf::Vertex vertex;
+    vertex.position = {static_cast<float>(next() % 100000) * 0.001f,
+                       static_cast<float>(next() % 100000) * 0.001f};
+    vertex.color = sf::Color(static_cast<std::uint8_t>(next()),
+                             static_cast<std::uint8_t>(next()),
+                             static_cast<std::uint8_t>(next()));
+    snapshot.m_vertices.push_back(vertex);
+  }
+  return snapshot;
+}
+
+/////////////////////////////////////////////////
+/// @brief Whether a decoded value is within half a quantization step, plus
+/// the rounding to float, of the original
+/////////////////////////////////////////////////
+bool IsNear(float original, float decoded, float min, float max) {
+  const double tolerance =
+      0.5 * GetQuantizationStep(min, max) +
+      std::abs(original) * std::numeric_limits<float>::epsilon();
+  return std::abs(static_cast<double>(decoded) - original) <= tolerance;
+}
+
+/////////////////////////////////////////////////
+void CheckRoundTrip(const CompressedVertexFileReader &reader,
+                    const std::vector<TestSnapshot> &snapshots) {
+  Check(reader.GetSnapshotCount() == snapshots.size(), "snapshot count");
+  DecodedSnapshot decoded;
+  for (size_t s = 0; s < snapshots.size(); ++s) {
+    const TestSnapshot &snapshot = snapshots[s];
+    const CompressedVertexFileEntry &entry = reader.GetEntry(s);
+    reader.Decode(s, decoded);
+    const std::string name = "snapshot " + std::to_string(s);
+    Check(decoded.m_index == s, name + " index");
+    Check(decoded.m_x.size() == snapshot.m_vertices.size() &&
+              decoded.m_depth.size() == snapshot.m_depth.size(),
+          name + " size");
+    if (decoded.m_x.size() != snapshot.m_vertices.size() ||
+        decoded.m_depth.size() != snapshot.m_depth.size())
+      continue;
+
+    size_t num_bad = 0;
+    for (size_t i = 0; i < snapshot.m_vertices.size(); ++i) {
+      const sf::Vertex &vertex = snapshot.m_vertices[i];
+      const VertexFileColor &color = decoded.m_colors[i];
+      if (!IsNear(vertex.position.x, decoded.m_x[i], entry.m_min_x,
+                  entry.m_max_x) ||
+          !IsNear(vertex.position.y, decoded.m_y[i], entry.m_min_y,
+                  entry.m_max_y) ||
+          color.r != vertex.color.r || color.g != vertex.color.g ||
+          color.b != vertex.color.b || color.a != vertex.color.a)
+        ++num_bad;
+      if (!snapshot.m_depth.empty() &&
+          !IsNear(snapshot.m_depth[i], decoded.m_depth[i], entry.m_min_depth,
+                  entry.m_max_depth))
+        ++num_bad;
+    }
+    Check(num_bad == 0, name + " has " + std::to_string(num_bad) +
+                            " vertices that did not round trip");
+  }
+}
+
+/////////////////////////////////////////////////
+std::vector<char> ReadFile(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file),
+          std::istreambuf_iterator<char>()};
+}
+
+/////////////////////////////////////////////////
+void WriteFile(const std::filesystem::path &path,
+               const std::vector<char> &bytes) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+/////////////////////////////////////////////////
+std::uint64_t ReadVarint(const std::vector<char> &bytes, size_t &position) {
+  std::uint64_t value = 0;
+  for (unsigned shift = 0;; shift += 7) {
+    const auto byte = static_cast<std::uint8_t>(bytes[position++]);
+    value |= std::uint64_t{byte & 0x7fu} << shift;
+    if ((byte & 0x80u) == 0)
+      return value;
+  }
+}
+
+/////////////////////////////////////////////////
+/// @brief Zero the payload, initial state included, of the rANS channel at
+/// offset
+/////////////////////////////////////////////////
+void ZeroRansPayload(std::vector<char> &bytes, size_t offset) {
+  size_t position = offset + 1;
+  ReadVarint(bytes, position);
+  const std::uint64_t num_symbols = ReadVarint(bytes, position);
+  for (std::uint64_t i = 0; i < num_symbols; ++i) {
+    ++position;
+    ReadVarint(bytes, position);
+  }
+  const std::uint64_t payload_size = ReadVarint(bytes, position);
+  std::fill_n(bytes.begin() + static_cast<std::ptrdiff_t>(position),
+              payload_size, 0);
+}
+
+/////////////////////////////////////////////////
+/// @brief Where the table entry of a snapshot is
+/////////////////////////////////////////////////
+size_t GetEntryOffset(const std::vector<char> &bytes, size_t snapshot) {
+  CompressedVertexFileHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  return static_cast<size_t>(header.m_table_offset) +
+         snapshot * sizeof(CompressedVertexFileEntry);
+}
+
+/////////////////////////////////////////////////
+/// @brief Whether decoding a snapshot of a file throws
+/////////////////////////////////////////////////
+bool DecodeThrows(const std::filesystem::path &path, size_t snapshot) {
+  try {
+    CompressedVertexFileReader reader(path);
+    DecodedSnapshot decoded;
+    reader.Decode(snapshot, decoded);
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
+int main() {
+  const std::filesystem::path folder =
+      std::filesystem::temp_directory_path();
+  const std::filesystem::path path = folder / "compressed_vertex_file.bin";
+  const std::filesystem::path corrupt_path =
+      folder / "compressed_vertex_file_corrupt.bin";
+
+  TestSnapshot tiny;
+  tiny.m_vertices.resize(3);
+  tiny.m_vertices[1].position = {1.0f, 2.0f};
+  tiny.m_vertices[2].color = sf::Color::Blue;
+
+  const std::vector<TestSnapshot> snapshots{
+      tiny,
+      MakeThresholdSnapshot(kMinRansBytes - 1),
+      MakeThresholdSnapshot(kMinRansBytes),
+      MakeSmoothSnapshot(),
+      MakeConstantSnapshot(),
+      MakeNoiseSnapshot(),
+      TestSnapshot{}};
+  constexpr size_t kSmooth = 3;
+  constexpr size_t kConstant = 4;
+
+  try {
+    {
+      SnapshotWriter writer(path, VertexFileEncoding::Compressed);
+      for (size_t s = 0; s < snapshots.size(); ++s) {
+        writer.Write(Snapshot{s, snapshots[s].m_vertices,
+                              snapshots[s].m_depth});
+      }
+      writer.Close();
+    }
+
+    const std::vector<char> bytes = ReadFile(path);
+    {
+      CompressedVertexFileReader reader(path);
+      CheckRoundTrip(reader, snapshots);
+
+      // the first byte of a snapshot's data is the coding of its x channel
+      auto x_coding = [&](size_t s) {
+        return static_cast<ChannelCoding>(bytes[reader.GetEntry(s).m_offset]);
+      };
+      Check(x_coding(0) == ChannelCoding::Raw, "tiny channel is not raw");
+      Check(x_coding(1) == ChannelCoding::Raw,
+            "channel below kMinRansBytes is not raw");
+      Check(x_coding(2) == ChannelCoding::Rans,
+            "channel at kMinRansBytes is not rANS coded");
+      Check(x_coding(kSmooth) == ChannelCoding::Rans,
+            "smooth channel is not rANS coded");
+      Check(x_coding(kConstant) == ChannelCoding::Rans,
+            "constant channel is not rANS coded");
+
+      const CompressedVertexFileEntry &entry = reader.GetEntry(kSmooth);
+      std::vector<char> corrupt = bytes;
+      corrupt[entry.m_offset] = 7;
+      WriteFile(corrupt_path, corrupt);
+      Check(DecodeThrows(corrupt_path, kSmooth), "bad coding accepted");
+
+      corrupt = bytes;
+      corrupt[entry.m_offset + entry.m_size / 2] ^= 0x5a;
+      WriteFile(corrupt_path, corrupt);
+      Check(DecodeThrows(corrupt_path, kSmooth), "corrupt payload accepted");
+
+      // a zero state fed only zeros never renormalizes back into range
+      corrupt = bytes;
+      ZeroRansPayload(corrupt, entry.m_offset);
+      WriteFile(corrupt_path, corrupt);
+      Check(DecodeThrows(corrupt_path, kSmooth), "zero rANS state accepted");
+
+      corrupt = bytes;
+      const std::uint64_t num_vertices = std::uint64_t{1} << 40;
+      std::memcpy(corrupt.data() + GetEntryOffset(bytes, kSmooth) +
+                      offsetof(CompressedVertexFileEntry, m_num_vertices),
+                  &num_vertices, sizeof(num_vertices));
+      WriteFile(corrupt_path, corrupt);
+      Check(DecodeThrows(corrupt_path, kSmooth),
+            "inflated vertex count accepted");
+    }
+
+    // a writer destroyed without Close, as when a sweep throws, leaves a
+    // file no reader takes for complete
+    {
+      SnapshotWriter writer(corrupt_path, VertexFileEncoding::Compressed);
+      writer.Write(Snapshot{0, snapshots[kSmooth].m_vertices, {}});
+    }
+    Check(DecodeThrows(corrupt_path, 0), "unclosed file accepted");
+
+    WriteFile(corrupt_path,
+              std::vector<char>(bytes.begin(), bytes.begin() +
+                                                   static_cast<std::ptrdiff_t>(
+                                                       bytes.size() / 2)));
+    Check(DecodeThrows(corrupt_path, 0), "truncated file accepted");
+  } catch (const std::exception &error) {
+    Check(false, error.what());
+  }
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(corrupt_path);
+  if (g_num_failures != 0)
+    return EXIT_FAILURE;
+  std::cout << "CompressedVertexFileTest passed." << std::endl;
+  return EXIT_SUCCESS;
+}